@@ -1,12 +1,17 @@
 /* BareMetal File System Utility */
 /* Written by Ian Seyler of Return Infinity */
 
+/* Feature test macro for fileno, ftruncate and clock_gettime under -std=c99 */
+#define _XOPEN_SOURCE 500
+
 /* Global includes */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
 #include <ctype.h>
+#include <time.h>
+#include <unistd.h>
 
 /* Global defines */
 struct BMFSEntry
@@ -21,6 +26,8 @@ struct BMFSEntry
 /* Global constants */
 // Min disk size is 6MiB (three blocks of 2MiB each.)
 const unsigned long long minimumDiskSize = (6 * 1024 * 1024);
+// File contents are moved one BMFS block (2MiB) at a time.
+const unsigned long long blockSize = (2 * 1024 * 1024);
 
 /* Global variables */
 FILE *file, *disk;
@@ -35,6 +42,7 @@ char s_create[] = "create";
 char s_read[] = "read";
 char s_write[] = "write";
 char s_delete[] = "delete";
+char s_benchmark[] = "benchmark";
 struct BMFSEntry entry;
 void *pentry = &entry;
 char *BlockMap;
@@ -48,9 +56,11 @@ void list();
 void format();
 int initialize(char *diskname, char *size, char *mbr, char *boot, char *kernel);
 void create(char *filename, unsigned long long maxsize);
-void read(char *filename);
-void write(char *filename);
+void readfile(char *filename);
+void writefile(char *filename);
 void delete(char *filename);
+void benchmark(char *filename);
+unsigned long long copyblocks(FILE *source, FILE *target, unsigned long long size);
 
 /* Program code */
 int main(int argc, char *argv[])
@@ -62,7 +72,7 @@ int main(int argc, char *argv[])
 		printf("Written by Ian Seyler @ Return Infinity (ian.seyler@returninfinity.com)\n\n");
 		printf("Usage: %s disk function file\n", argv[0]);
 		printf("Disk: the name of the disk file\n");
-		printf("Function: list, read, write, create, delete, format, initialize\n");
+		printf("Function: list, read, write, create, delete, format, initialize, benchmark\n");
 		printf("File: (if applicable)\n");
 		exit(0);
 	}
@@ -177,16 +187,20 @@ int main(int argc, char *argv[])
 	}
 	else if (strcasecmp(s_read, command) == 0)
 	{
-		read(filename);
+		readfile(filename);
 	}
 	else if (strcasecmp(s_write, command) == 0)
 	{
-		write(filename);
+		writefile(filename);
 	}
 	else if (strcasecmp(s_delete, command) == 0)
 	{
 		delete(filename);
 	}
+	else if (strcasecmp(s_benchmark, command) == 0)
+	{
+		benchmark(filename);
+	}
 	else
 	{
 		printf("Unknown command\n");
@@ -443,8 +457,14 @@ int initialize(char *diskname, char *size, char *mbr, char *boot, char *kernel)
 		}
 	}
 
-	// Fill the disk image with zeros.
-	if (ret == 0)
+	// Size the disk image. Extending the empty file with ftruncate leaves
+	// it sparse, so no zeros have to be written. Devices and file systems
+	// that can't be truncated fall back to writing the zeros.
+	if (ret == 0 && ftruncate(fileno(disk), diskSize) == 0)
+	{
+		printf("Formatting disk: %llu bytes (sparse)\n", diskSize);
+	}
+	else if (ret == 0)
 	{
 		double percent;
 		memset(buffer, 0, bufferSize);
@@ -717,11 +737,11 @@ void create(char *filename, unsigned long long maxsize)
 }
 
 
-void read(char *filename)
+void readfile(char *filename)
 {
 	struct BMFSEntry tempentry;
 	FILE *tfile;
-	int tint, slot;
+	int slot;
 
 	if (0 == findfile(filename, &tempentry, &slot))
 	{
@@ -736,24 +756,26 @@ void read(char *filename)
 		}
 		else
 		{
-			fseek(disk, tempentry.StartingBlock*2097152, SEEK_SET); // Skip to the starting block in the disk
-			for (tint=0; tint<tempentry.FileSize; tint++)
+			fseek(disk, tempentry.StartingBlock*blockSize, SEEK_SET); // Skip to the starting block in the disk
+			if (copyblocks(disk, tfile, tempentry.FileSize) != tempentry.FileSize)
+			{
+				printf("Error: Failed to read file from disk '%s'\n", diskname);
+			}
+			else
 			{
-				putc(getc(disk), tfile);			// This is really terrible.
-				// TODO: Rework with fread and fwrite (ideally with a 2MiB buffer)
+				printf("Complete\n");
 			}
 			fclose(tfile);
-			printf("Complete\n");
 		}
 	}
 }
 
 
-void write(char *filename)
+void writefile(char *filename)
 {
 	struct BMFSEntry tempentry;
 	FILE *tfile;
-	int tint, slot;
+	int slot;
 	unsigned long long tempfilesize;
 
 	if (0 == findfile(filename, &tempentry, &slot))
@@ -773,18 +795,17 @@ void write(char *filename)
 			fseek(tfile, 0, SEEK_END);
 			tempfilesize = ftell(tfile);
 			rewind(tfile);
-			if ((tempentry.ReservedBlocks*2097152) < tempfilesize)
+			if ((tempentry.ReservedBlocks*blockSize) < tempfilesize)
 			{
 				printf("Not enough reserved space in BMFS.\n");
 			}
+			else if (fseek(disk, tempentry.StartingBlock*blockSize, SEEK_SET) != 0 || // Skip to the starting block in the disk
+				copyblocks(tfile, disk, tempfilesize) != tempfilesize)
+			{
+				printf("Error: Failed to write disk '%s'\n", diskname);
+			}
 			else
 			{
-				fseek(disk, tempentry.StartingBlock*2097152, SEEK_SET); // Skip to the starting block in the disk
-				for (tint=0; tint<tempfilesize; tint++)
-				{
-					putc(getc(tfile), disk);			// This is really terrible.
-					// TODO: Rework with fread and fwrite (ideally with a 2MiB buffer)
-				}
 				// Update directory
 				memcpy(Directory+(slot*64)+48, &tempfilesize, 8);
 				fseek(disk, 4096, SEEK_SET);				// Seek 4KiB in for directory
@@ -819,4 +840,109 @@ void delete(char *filename)
 }
 
 
+// Copies size bytes from source to target a BMFS block at a time.
+// Returns the number of bytes actually copied.
+unsigned long long copyblocks(FILE *source, FILE *target, unsigned long long size)
+{
+	unsigned long long copied = 0;
+	size_t chunkSize;
+	char *buffer = (char *) malloc(blockSize);
+
+	if (buffer == NULL)
+	{
+		printf("Error: Failed to allocate buffer\n");
+		return 0;
+	}
+
+	while (copied < size)
+	{
+		chunkSize = blockSize;
+		if (chunkSize > size - copied)
+		{
+			chunkSize = size - copied;
+		}
+		chunkSize = fread(buffer, 1, chunkSize, source);
+		if (chunkSize == 0 || fwrite(buffer, 1, chunkSize, target) != chunkSize)
+		{
+			break;
+		}
+		copied += chunkSize;
+	}
+
+	free(buffer);
+	return copied;
+}
+
+
+static double elapsedseconds(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+// Writes a local file to BMFS and reads it back, reporting the throughput
+// of each direction. The BMFS entry must already exist (see create).
+void benchmark(char *filename)
+{
+	struct BMFSEntry tempentry;
+	struct timespec start;
+	FILE *tfile, *scratch;
+	int slot;
+	unsigned long long tempfilesize, copied;
+	double seconds;
+
+	if (filename == NULL)
+	{
+		printf("Error: File name not specified.\n");
+	}
+	else if (0 == findfile(filename, &tempentry, &slot))
+	{
+		printf("Error: File not found in BMFS. A file entry must first be created.\n");
+	}
+	else if ((tfile = fopen(filename, "rb")) == NULL)
+	{
+		printf("Error: Could not open local file '%s'\n", filename);
+	}
+	else
+	{
+		fseek(tfile, 0, SEEK_END);
+		tempfilesize = ftell(tfile);
+		rewind(tfile);
+		if ((tempentry.ReservedBlocks*blockSize) < tempfilesize)
+		{
+			printf("Not enough reserved space in BMFS.\n");
+		}
+		else if ((scratch = tmpfile()) == NULL)
+		{
+			printf("Error: Could not create scratch file\n");
+		}
+		else
+		{
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			fseek(disk, tempentry.StartingBlock*blockSize, SEEK_SET);
+			copied = copyblocks(tfile, disk, tempfilesize);
+			fflush(disk);
+			seconds = elapsedseconds(&start);
+			printf("Write: %llu bytes in %.3f s (%.1f MB/s)\n", copied, seconds, copied / seconds / 1e6);
+
+			memcpy(Directory+(slot*64)+48, &copied, 8);
+			fseek(disk, 4096, SEEK_SET);
+			fwrite(Directory, 4096, 1, disk);
+
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			fseek(disk, tempentry.StartingBlock*blockSize, SEEK_SET);
+			copied = copyblocks(disk, scratch, copied);
+			fflush(scratch);
+			seconds = elapsedseconds(&start);
+			printf("Read:  %llu bytes in %.3f s (%.1f MB/s)\n", copied, seconds, copied / seconds / 1e6);
+
+			fclose(scratch);
+		}
+		fclose(tfile);
+	}
+}
+
+
 /* EOF */
@@ -1,5 +1,7 @@
 GLOBAL _cli
 GLOBAL _sti
+GLOBAL _disableInterrupts
+GLOBAL _restoreInterrupts
 GLOBAL _hlt
 GLOBAL picMasterMask
 GLOBAL picSlaveMask
@@ -7,15 +9,18 @@ GLOBAL haltcpu
 
 GLOBAL _irq00Handler
 GLOBAL _irq01Handler
+GLOBAL _irq14Handler
 
 GLOBAL _exception0Handler
 GLOBAL _exception1Handler
+GLOBAL _pageFaultHandler
 
 GLOBAL _systemCallHandler
 
 EXTERN systemCallDispatcher
 EXTERN irqDispatcher
 EXTERN exceptionDispatcher
+EXTERN pageFaultDispatcher
 EXTERN load_idt
 EXTERN nextProcess
 
@@ -84,6 +89,27 @@ SECTION .text
 	iretq
 %endmacro
 
+; Las IRQ del slave necesitan EOI en ambos PIC
+%macro irqHandlerSlave 1
+	pushState
+
+	mov rdi, %1 ; pasaje de parametro
+	call irqDispatcher
+
+	mov rdi, rsp
+	call nextProcess
+
+	mov rsp, rax
+
+	; signal pic EOI (End of Interrupt)
+	mov al, 20h
+	out 0A0h, al
+	out 20h, al
+
+	popState
+	iretq
+%endmacro
+
 %macro exceptionHandler 1
 	pushState
 	push rsp
@@ -114,6 +140,21 @@ _sti:
 	sti
 	ret
 
+; _disableInterrupts -- Apaga las interrupciones
+; OUT:	RAX = RFLAGS anterior, para _restoreInterrupts
+_disableInterrupts:
+	pushfq
+	pop rax
+	cli
+	ret
+
+; _restoreInterrupts -- Vuelve IF al estado que tenia
+; IN:	RDI = RFLAGS devuelto por _disableInterrupts
+_restoreInterrupts:
+	push rdi
+	popfq
+	ret
+
 
 _changeProcess:
 	mov rsp, rdi
@@ -159,6 +200,10 @@ _irq00Handler:
 _irq01Handler:
 	irqHandlerMaster 1
 
+;Primary ATA channel
+_irq14Handler:
+	irqHandlerSlave 14
+
 ;Zero Division Exception
 _exception0Handler:
 	exceptionHandler 0
@@ -167,6 +212,35 @@ _exception0Handler:
 _exception1Handler:
 	exceptionHandler 6
 
+;Page Fault Exception
+;Las paginas de archivos mapeados se cargan aca, si no es una de ellas
+;sigue como las demas excepciones
+_pageFaultHandler:
+	pushState
+
+	mov rdi, cr2 ; direccion que fallo
+	mov rsi, [rsp + 17*8] ; codigo de error que pushea el cpu
+	call pageFaultDispatcher
+
+	cmp rax, 0
+	je .invalid
+
+	popState
+	add rsp, 8 ; saca el codigo de error
+	iretq
+
+.invalid:
+	push rsp
+	mov rdi, 14
+	mov rsi, rsp
+	call exceptionDispatcher
+	pop rsp
+	popState
+	add rsp, 8
+
+	mov qword [rsp], 0x400000
+	iretq
+
 ;System Calls
 _systemCallHandler:
     pushState
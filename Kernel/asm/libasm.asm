@@ -3,8 +3,15 @@ GLOBAL getTimeRTC
 GLOBAL getKeyCode
 GLOBAL speakerOn
 GLOBAL speakerOff
-GLOBAL speakerBeep
-GLOBAL delayLoop
+GLOBAL inb
+GLOBAL outb
+GLOBAL insw
+GLOBAL outsw
+GLOBAL inl
+GLOBAL outl
+GLOBAL writeCR3
+GLOBAL invalidatePage
+GLOBAL readTSC
 
 SECTION .text
 
@@ -102,36 +109,75 @@ speakerOff:
   	pop rbp
 	ret
 
-speakerBeep:
-	push rbp
-  	mov rbp, rsp
+; inb -- Reads a byte from an I/O port
+; IN:	RDI = port
+; OUT:	RAX = byte read
+inb:
+	mov rdx, rdi
+	xor rax, rax
+	in al, dx
+	ret
 
-	mov rdi, 0x0000000000000C80
-	call speakerOn
+; outb -- Writes a byte to an I/O port
+; IN:	RDI = port, RSI = byte
+outb:
+	mov rdx, rdi
+	mov rax, rsi
+	out dx, al
+	ret
 
-	mov rdi, 10000000
-	call delayLoop
+; insw -- Reads words from an I/O port into a buffer
+; IN:	RDI = port, RSI = buffer, RDX = amount of words
+insw:
+	mov rcx, rdx
+	mov rdx, rdi
+	mov rdi, rsi
+	cld
+	rep insw
+	ret
 
-	call speakerOff
+; outsw -- Writes words from a buffer to an I/O port
+; IN:	RDI = port, RSI = buffer, RDX = amount of words
+outsw:
+	mov rcx, rdx
+	mov rdx, rdi
+	cld
+	rep outsw
+	ret
 
-	mov rsp, rbp
-  	pop rbp
+; inl -- Reads a double word from an I/O port
+; IN:	RDI = port
+; OUT:	RAX = double word read
+inl:
+	mov rdx, rdi
+	xor rax, rax
+	in eax, dx
 	ret
 
-delayLoop:
-	push rbp
-  	mov rbp, rsp
-	
-	push rax
-	mov rax, 0
-	.delay:
-		inc rax
-		cmp rax, rdi
-		je .fin
-		jmp .delay
-	
-	.fin:
-	pop rax
-	mov rsp, rbp
-  	pop rbp
-	ret
\ No newline at end of file
+; outl -- Writes a double word to an I/O port
+; IN:	RDI = port, RSI = double word
+outl:
+	mov rdx, rdi
+	mov rax, rsi
+	out dx, eax
+	ret
+
+; writeCR3 -- Switches page tables, flushing the TLB
+; IN:	RDI = physical address of the page map level 4
+writeCR3:
+	mov cr3, rdi
+	ret
+
+; invalidatePage -- Drops the TLB entry of an address
+; IN:	RDI = virtual address
+invalidatePage:
+	invlpg [rdi]
+	ret
+
+; readTSC -- Reads the time stamp counter
+; OUT:	RAX = cycles since reset
+readTSC:
+	rdtsc
+	shl rdx, 32
+	or rax, rdx
+	ret
@@ -0,0 +1,436 @@
+#include <ataDriver.h>
+#include <pci.h>
+#include <interrupts.h>
+#include <scheduler.h>
+#include <processes.h>
+#include <lib.h>
+
+/* Primary bus, master drive, 48 bit LBA */
+#define ATA_DATA 0x1F0
+#define ATA_ERROR 0x1F1
+#define ATA_SECTOR_COUNT 0x1F2
+#define ATA_LBA_LOW 0x1F3
+#define ATA_LBA_MID 0x1F4
+#define ATA_LBA_HIGH 0x1F5
+#define ATA_DRIVE 0x1F6
+#define ATA_STATUS 0x1F7
+#define ATA_COMMAND 0x1F7
+#define ATA_CONTROL 0x3F6
+
+#define ATA_BSY 0x80
+#define ATA_DF 0x20
+#define ATA_DRQ 0x08
+#define ATA_ERR 0x01
+
+#define ATA_NIEN 0x02
+
+#define ATA_CMD_READ_EXT 0x24
+#define ATA_CMD_READ_DMA_EXT 0x25
+#define ATA_CMD_WRITE_EXT 0x34
+#define ATA_CMD_WRITE_DMA_EXT 0x35
+#define ATA_CMD_FLUSH_EXT 0xEA
+#define ATA_CMD_IDENTIFY 0xEC
+
+#define ATA_MASTER_LBA 0x40
+
+/* Vueltas de polling antes de dar el disco por colgado */
+#define ATA_TIMEOUT 10000000
+
+/* IDE bus master registers, from BAR4 of the controller */
+#define BM_COMMAND 0x0
+#define BM_STATUS 0x2
+#define BM_PRDT 0x4
+
+#define BM_START 0x1
+#define BM_READ 0x8 /* Device to memory */
+#define BM_ERROR 0x2
+#define BM_INTERRUPT 0x4
+
+#define PCI_CLASS_STORAGE 0x01
+#define PCI_SUBCLASS_IDE 0x01
+#define IDE_NATIVE_PRIMARY 0x01
+#define IDE_BUS_MASTER 0x80
+
+/* A PRD may not cross a 64KiB boundary, so a transfer of
+** ATA_MAX_SECTORS needs at most three of them */
+#define PRD_ENTRIES 4
+#define PRD_END 0x8000
+#define PRD_BOUNDARY 0x10000
+
+typedef struct
+{
+	uint32_t address;
+	uint16_t bytes; /* 0 means 64KiB */
+	uint16_t flags;
+} prdEntry;
+
+static void initializeBusMaster();
+static void enqueueRequest(diskRequest *request);
+static diskRequest *dequeueRequest();
+static void startNext();
+static void finishRequest(diskRequest *request, int result);
+static void buildPrdTable(diskRequest *request);
+static int pioTransfer(diskRequest *request);
+static int waitReady();
+static int waitData();
+static void selectSectors(uint64_t lba, uint64_t count);
+
+static uint64_t sectorCount = 0;
+static uint16_t busMaster = 0;
+
+/* 32 bytes aligned to 32 never cross a 64KiB boundary */
+static prdEntry prdTable[PRD_ENTRIES] __attribute__((aligned(32)));
+
+/* C-SCAN: requests ahead of the head sorted by LBA, the rest wait for
+** the next sweep */
+static diskRequest *active = NULL;
+static diskRequest *sweep = NULL;
+static diskRequest *nextSweep = NULL;
+static uint64_t headPosition = 0;
+
+int ataInitialize()
+{
+	uint16_t identify[SECTOR_SIZE / 2];
+
+	/* IDENTIFY is polled, the drive must not raise IRQ14 yet */
+	outb(ATA_CONTROL, ATA_NIEN);
+	outb(ATA_DRIVE, 0xA0);
+	outb(ATA_SECTOR_COUNT, 0);
+	outb(ATA_LBA_LOW, 0);
+	outb(ATA_LBA_MID, 0);
+	outb(ATA_LBA_HIGH, 0);
+	outb(ATA_COMMAND, ATA_CMD_IDENTIFY);
+
+	/* 0 means there is no drive and 0xFF a floating bus */
+	if (inb(ATA_STATUS) == 0 || inb(ATA_STATUS) == 0xFF || !waitReady())
+		return 0;
+
+	/* ATAPI and SATA devices answer with a signature instead */
+	if (inb(ATA_LBA_MID) != 0 || inb(ATA_LBA_HIGH) != 0 || !waitData())
+		return 0;
+
+	insw(ATA_DATA, identify, SECTOR_SIZE / 2);
+
+	/* Words 100-103 hold the LBA48 size if bit 10 of word 83 is set */
+	if (identify[83] & (1 << 10))
+		sectorCount = identify[100] | ((uint64_t)identify[101] << 16) |
+					  ((uint64_t)identify[102] << 32) | ((uint64_t)identify[103] << 48);
+	else
+		sectorCount = identify[60] | ((uint64_t)identify[61] << 16);
+
+	/* Bit 8 of word 49: the drive does DMA */
+	if (sectorCount != 0 && (identify[49] & (1 << 8)))
+		initializeBusMaster();
+
+	return sectorCount != 0;
+}
+
+/* Finds the IDE controller and, if the primary channel is in
+** compatibility mode behind a bus master, switches to DMA. */
+static void initializeBusMaster()
+{
+	pciDevice ide;
+	uint32_t bar;
+
+	if (!pciFindClass(PCI_CLASS_STORAGE, PCI_SUBCLASS_IDE, &ide) ||
+		(ide.progIf & IDE_NATIVE_PRIMARY) || !(ide.progIf & IDE_BUS_MASTER))
+		return;
+
+	bar = pciRead(&ide, PCI_BAR4);
+	if (!(bar & 1))
+		return;
+
+	pciWrite(&ide, PCI_COMMAND, pciRead(&ide, PCI_COMMAND) | PCI_COMMAND_IO | PCI_COMMAND_MASTER);
+	busMaster = bar & 0xFFFC;
+	outb(busMaster + BM_COMMAND, 0);
+	outb(busMaster + BM_STATUS, BM_INTERRUPT | BM_ERROR);
+
+	/* Completions come by IRQ14 from now on */
+	outb(ATA_CONTROL, 0);
+}
+
+uint64_t ataGetSectorCount()
+{
+	return sectorCount;
+}
+
+int ataUsesDMA()
+{
+	return busMaster != 0;
+}
+
+/* Queues the request and returns; ataWait gets the result. Without a
+** bus master the transfer is done right away with PIO. */
+void ataSubmit(diskRequest *request)
+{
+	uint64_t flags;
+
+	request->done = 0;
+	request->result = 0;
+	request->next = NULL;
+
+	if (request->operation != ATA_FLUSH &&
+		(request->count == 0 || request->count > ATA_MAX_SECTORS || request->lba + request->count > sectorCount))
+	{
+		request->done = 1;
+		return;
+	}
+
+	if (busMaster == 0)
+	{
+		request->result = pioTransfer(request);
+		request->done = 1;
+		return;
+	}
+
+	flags = _disableInterrupts();
+	enqueueRequest(request);
+	if (active == NULL)
+		startNext();
+	_restoreInterrupts(flags);
+}
+
+/* Processes sleep until the interrupt handler completes the request,
+** during boot there is no one else to run and the CPU just halts. */
+int ataWait(diskRequest *request)
+{
+	while (!request->done)
+	{
+		if (isSchedulerRunning())
+			sleepOn(request);
+		else
+			_hlt();
+	}
+
+	return request->result;
+}
+
+int ataRead(uint64_t lba, uint64_t count, void *buffer)
+{
+	diskRequest request = {lba, count, buffer, ATA_READ};
+
+	ataSubmit(&request);
+	return ataWait(&request);
+}
+
+int ataWrite(uint64_t lba, uint64_t count, const void *buffer)
+{
+	diskRequest request = {lba, count, (void *)buffer, ATA_WRITE};
+
+	ataSubmit(&request);
+	return ataWait(&request);
+}
+
+int ataFlush()
+{
+	diskRequest request = {0, 0, NULL, ATA_FLUSH};
+
+	if (sectorCount == 0)
+		return 0;
+
+	ataSubmit(&request);
+	return ataWait(&request);
+}
+
+void ata_handler()
+{
+	diskRequest *request = active;
+	uint8_t status, driveStatus;
+
+	if (busMaster == 0)
+		return;
+
+	status = inb(busMaster + BM_STATUS);
+	if (!(status & BM_INTERRUPT))
+		return;
+
+	outb(busMaster + BM_COMMAND, 0);
+	driveStatus = inb(ATA_STATUS); /* Also acknowledges the drive */
+	outb(busMaster + BM_STATUS, BM_INTERRUPT | BM_ERROR);
+
+	if (request == NULL)
+		return;
+
+	active = NULL;
+	finishRequest(request, !(status & BM_ERROR) && !(driveStatus & (ATA_ERR | ATA_DF)));
+	startNext();
+}
+
+static void enqueueRequest(diskRequest *request)
+{
+	diskRequest **list = request->lba >= headPosition ? &sweep : &nextSweep;
+
+	while (*list != NULL && (*list)->lba <= request->lba)
+		list = &(*list)->next;
+
+	request->next = *list;
+	*list = request;
+}
+
+static diskRequest *dequeueRequest()
+{
+	diskRequest *request;
+
+	if (sweep == NULL)
+	{
+		sweep = nextSweep;
+		nextSweep = NULL;
+	}
+
+	request = sweep;
+	if (request != NULL)
+	{
+		sweep = request->next;
+		headPosition = request->lba + request->count;
+	}
+
+	return request;
+}
+
+/* Runs with interrupts off, from ataSubmit or the interrupt handler */
+static void startNext()
+{
+	diskRequest *request;
+
+	while (active == NULL && (request = dequeueRequest()) != NULL)
+	{
+		if (!waitReady())
+		{
+			finishRequest(request, 0);
+			continue;
+		}
+
+		active = request;
+		outb(ATA_DRIVE, ATA_MASTER_LBA);
+
+		if (request->operation == ATA_FLUSH)
+		{
+			outb(ATA_COMMAND, ATA_CMD_FLUSH_EXT);
+			continue;
+		}
+
+		buildPrdTable(request);
+		outl(busMaster + BM_PRDT, (uint32_t)(uint64_t)prdTable);
+		outb(busMaster + BM_COMMAND, request->operation == ATA_READ ? BM_READ : 0);
+		outb(busMaster + BM_STATUS, BM_INTERRUPT | BM_ERROR);
+
+		selectSectors(request->lba, request->count);
+		outb(ATA_COMMAND, request->operation == ATA_READ ? ATA_CMD_READ_DMA_EXT : ATA_CMD_WRITE_DMA_EXT);
+		outb(busMaster + BM_COMMAND, (request->operation == ATA_READ ? BM_READ : 0) | BM_START);
+	}
+}
+
+static void finishRequest(diskRequest *request, int result)
+{
+	request->result = result;
+	request->done = 1;
+	wakeUp(request);
+}
+
+static void buildPrdTable(diskRequest *request)
+{
+	uint64_t address = (uint64_t)request->buffer;
+	uint64_t remaining = request->count * SECTOR_SIZE;
+	uint64_t chunk;
+	int i = 0;
+
+	while (remaining > 0)
+	{
+		chunk = PRD_BOUNDARY - (address & (PRD_BOUNDARY - 1));
+		if (chunk > remaining)
+			chunk = remaining;
+
+		prdTable[i].address = (uint32_t)address;
+		prdTable[i].bytes = (uint16_t)chunk;
+		prdTable[i].flags = 0;
+
+		address += chunk;
+		remaining -= chunk;
+		i++;
+	}
+
+	prdTable[i - 1].flags = PRD_END;
+}
+
+/* Polled fallback for controllers without a bus master */
+static int pioTransfer(diskRequest *request)
+{
+	uint8_t *buffer = request->buffer;
+	uint64_t i;
+
+	if (!waitReady())
+		return 0;
+
+	outb(ATA_DRIVE, ATA_MASTER_LBA);
+
+	if (request->operation == ATA_FLUSH)
+	{
+		outb(ATA_COMMAND, ATA_CMD_FLUSH_EXT);
+		return waitReady();
+	}
+
+	selectSectors(request->lba, request->count);
+	outb(ATA_COMMAND, request->operation == ATA_READ ? ATA_CMD_READ_EXT : ATA_CMD_WRITE_EXT);
+
+	for (i = 0; i < request->count; i++, buffer += SECTOR_SIZE)
+	{
+		if (!waitData())
+			return 0;
+		if (request->operation == ATA_READ)
+			insw(ATA_DATA, buffer, SECTOR_SIZE / 2);
+		else
+			outsw(ATA_DATA, buffer, SECTOR_SIZE / 2);
+	}
+
+	return request->operation == ATA_READ || waitReady();
+}
+
+/* LBA48 takes the high bytes of every register first */
+static void selectSectors(uint64_t lba, uint64_t count)
+{
+	outb(ATA_DRIVE, ATA_MASTER_LBA);
+	outb(ATA_SECTOR_COUNT, (count >> 8) & 0xFF);
+	outb(ATA_LBA_LOW, (lba >> 24) & 0xFF);
+	outb(ATA_LBA_MID, (lba >> 32) & 0xFF);
+	outb(ATA_LBA_HIGH, (lba >> 40) & 0xFF);
+	outb(ATA_SECTOR_COUNT, count & 0xFF);
+	outb(ATA_LBA_LOW, lba & 0xFF);
+	outb(ATA_LBA_MID, (lba >> 8) & 0xFF);
+	outb(ATA_LBA_HIGH, (lba >> 16) & 0xFF);
+}
+
+static int waitReady()
+{
+	uint64_t i;
+	uint8_t status;
+
+	/* Reading the alternate status four times gives the drive its 400ns */
+	for (i = 0; i < 4; i++)
+		inb(ATA_CONTROL);
+
+	for (i = 0; i < ATA_TIMEOUT; i++)
+	{
+		status = inb(ATA_STATUS);
+		if (!(status & ATA_BSY))
+			return !(status & (ATA_ERR | ATA_DF));
+	}
+
+	return 0;
+}
+
+static int waitData()
+{
+	uint64_t i;
+	uint8_t status;
+
+	for (i = 0; i < ATA_TIMEOUT; i++)
+	{
+		status = inb(ATA_STATUS);
+		if (status & (ATA_ERR | ATA_DF))
+			return 0;
+		if (!(status & ATA_BSY) && (status & ATA_DRQ))
+			return 1;
+	}
+
+	return 0;
+}
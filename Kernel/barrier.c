@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include "barrier.h"
+#include "lib.h"
+#include "processes.h"
+#include "scheduler.h"
+
+/* generation cambia cada vez que llegan todos, asi la barrera se puede
+** volver a usar enseguida sin que un atrasado pase de largo */
+typedef struct barrier_t
+{
+	int count;
+	int arrived;
+	uint64_t generation;
+	char *name;
+} barrier_t;
+
+static barrier_t *barriers[MAX_BARRIERS];
+
+/* Si ya existe con ese nombre se devuelve la misma, count se ignora */
+barrier_t *barrierInit(char *name, int count)
+{
+	int i, empty = -1;
+
+	for (i = 0; i < MAX_BARRIERS; i++)
+	{
+		if (barriers[i] == NULL)
+		{
+			if (empty < 0)
+				empty = i;
+		}
+		else if (strcmpKernel(name, barriers[i]->name) == 0)
+			return barriers[i];
+	}
+	if (empty < 0 || count <= 0)
+		return NULL;
+
+	barrier_t *barrier = (barrier_t *)malloc(sizeof(barrier_t));
+	barrier->name = (char *)malloc(strlenKernel(name) + 1);
+	strcpyKernel(barrier->name, name);
+	barrier->count = count;
+	barrier->arrived = 0;
+	barrier->generation = 0;
+	barriers[empty] = barrier;
+	return barrier;
+}
+
+/* Espera a que lleguen count procesos. Al ultimo en llegar le devuelve
+** 1 y a los demas 0, para que uno solo haga el trabajo de cierre. */
+int barrierWait(barrier_t *barrier)
+{
+	uint64_t generation = barrier->generation;
+
+	if (++barrier->arrived == barrier->count)
+	{
+		barrier->arrived = 0;
+		barrier->generation++;
+		wakeUp(barrier);
+		return 1;
+	}
+
+	while (barrier->generation == generation)
+		sleepOn(barrier);
+	return 0;
+}
+
+int barrierClose(barrier_t *barrier)
+{
+	int i;
+
+	for (i = 0; i < MAX_BARRIERS; i++)
+	{
+		if (barriers[i] == barrier)
+		{
+			barriers[i] = NULL;
+			free(barrier->name);
+			free(barrier);
+			return 0;
+		}
+	}
+	return 1;
+}
@@ -0,0 +1,295 @@
+#include <blockCache.h>
+#include <ataDriver.h>
+#include <lib.h>
+
+#define SECTORS_PER_BLOCK (CACHE_BLOCK_SIZE / SECTOR_SIZE)
+#define BLOCKS_PER_BMFS_BLOCK (BMFS_BLOCK_SIZE / CACHE_BLOCK_SIZE)
+#define HASH_SIZE 64
+
+typedef struct cacheBlock
+{
+	uint64_t block;
+	uint8_t *data;
+	int valid;
+	int dirty;
+	diskRequest request; /* For write-backs */
+	struct cacheBlock *older; /* LRU list, newest first */
+	struct cacheBlock *newer;
+	struct cacheBlock *nextInBucket;
+} cacheBlock;
+
+static cacheBlock *getBlock(uint64_t block, int fill);
+static cacheBlock *findBlock(uint64_t block);
+static cacheBlock *evictBlock();
+static int readAhead(uint64_t block);
+static int writeBack(cacheBlock *entry);
+static void submitWriteBack(cacheBlock *entry);
+static int waitWriteBack(cacheBlock *entry);
+static void touch(cacheBlock *entry);
+static void unlink(cacheBlock *entry);
+static void hashInsert(cacheBlock *entry);
+static void hashRemove(cacheBlock *entry);
+
+static cacheBlock blocks[CACHE_BLOCKS];
+static cacheBlock *buckets[HASH_SIZE];
+static cacheBlock *newest = NULL;
+static cacheBlock *oldest = NULL;
+static uint8_t *readAheadBuffer;
+static uint64_t diskBlocks = 0;
+static cacheStats stats;
+
+void initializeBlockCache()
+{
+	uint8_t *memory = (uint8_t *)getStackPage();
+	int i;
+
+	diskBlocks = ataGetSectorCount() / SECTORS_PER_BLOCK;
+	readAheadBuffer = memory + CACHE_BLOCKS * CACHE_BLOCK_SIZE;
+
+	for (i = 0; i < CACHE_BLOCKS; i++)
+	{
+		blocks[i].data = memory + i * CACHE_BLOCK_SIZE;
+		blocks[i].valid = 0;
+		blocks[i].dirty = 0;
+		blocks[i].older = NULL;
+		blocks[i].newer = NULL;
+		touch(&blocks[i]);
+	}
+}
+
+int64_t cacheRead(uint64_t position, void *buffer, uint64_t length)
+{
+	uint8_t *destination = buffer;
+	uint64_t done = 0, offset, chunk;
+	cacheBlock *entry;
+
+	while (done < length)
+	{
+		offset = (position + done) % CACHE_BLOCK_SIZE;
+		chunk = CACHE_BLOCK_SIZE - offset;
+		if (chunk > length - done)
+			chunk = length - done;
+
+		entry = getBlock((position + done) / CACHE_BLOCK_SIZE, 1);
+		if (entry == NULL)
+			return done > 0 ? done : -1;
+
+		memcpy(destination + done, entry->data + offset, chunk);
+		done += chunk;
+	}
+
+	return done;
+}
+
+int64_t cacheWrite(uint64_t position, const void *buffer, uint64_t length)
+{
+	const uint8_t *source = buffer;
+	uint64_t done = 0, offset, chunk;
+	cacheBlock *entry;
+
+	while (done < length)
+	{
+		offset = (position + done) % CACHE_BLOCK_SIZE;
+		chunk = CACHE_BLOCK_SIZE - offset;
+		if (chunk > length - done)
+			chunk = length - done;
+
+		/* A block that is overwritten whole is not read first */
+		entry = getBlock((position + done) / CACHE_BLOCK_SIZE, chunk != CACHE_BLOCK_SIZE);
+		if (entry == NULL)
+			return done > 0 ? done : -1;
+
+		memcpy(entry->data + offset, source + done, chunk);
+		entry->dirty = 1;
+		done += chunk;
+	}
+
+	return done;
+}
+
+/* Writes every dirty block back and flushes the drive's own cache.
+** All write-backs are queued at once so the driver can sort them. */
+int cacheSync()
+{
+	int i, ok = 1;
+
+	for (i = 0; i < CACHE_BLOCKS; i++)
+		if (blocks[i].valid && blocks[i].dirty)
+			submitWriteBack(&blocks[i]);
+
+	for (i = 0; i < CACHE_BLOCKS; i++)
+		if (blocks[i].valid && blocks[i].dirty && !waitWriteBack(&blocks[i]))
+			ok = 0;
+
+	return ataFlush() && ok;
+}
+
+void getCacheStats(cacheStats *result)
+{
+	*result = stats;
+}
+
+static cacheBlock *getBlock(uint64_t block, int fill)
+{
+	cacheBlock *entry;
+
+	if (block >= diskBlocks)
+		return NULL;
+
+	entry = findBlock(block);
+	if (entry != NULL)
+	{
+		stats.hits++;
+		touch(entry);
+		return entry;
+	}
+
+	stats.misses++;
+	if (fill)
+	{
+		if (!readAhead(block))
+			return NULL;
+		return findBlock(block);
+	}
+
+	entry = evictBlock();
+	if (entry == NULL)
+		return NULL;
+	entry->block = block;
+	entry->valid = 1;
+	hashInsert(entry);
+	touch(entry);
+	return entry;
+}
+
+/* Reads block and the ones after it that are not cached yet, up to
+** READ_AHEAD_BLOCKS and the end of its BMFS block, with one command. */
+static int readAhead(uint64_t block)
+{
+	uint64_t count = 1, i;
+	uint64_t limit = (block / BLOCKS_PER_BMFS_BLOCK + 1) * BLOCKS_PER_BMFS_BLOCK;
+	cacheBlock *entry;
+
+	if (limit > diskBlocks)
+		limit = diskBlocks;
+
+	while (count < READ_AHEAD_BLOCKS && block + count < limit && findBlock(block + count) == NULL)
+		count++;
+
+	if (!ataRead(block * SECTORS_PER_BLOCK, count * SECTORS_PER_BLOCK, readAheadBuffer))
+		return 0;
+
+	stats.readAhead += count - 1;
+
+	/* The requested block goes in last so it ends up the newest */
+	for (i = count; i-- > 0;)
+	{
+		entry = evictBlock();
+		if (entry == NULL)
+			return 0;
+		memcpy(entry->data, readAheadBuffer + i * CACHE_BLOCK_SIZE, CACHE_BLOCK_SIZE);
+		entry->block = block + i;
+		entry->valid = 1;
+		hashInsert(entry);
+		touch(entry);
+	}
+
+	return 1;
+}
+
+static cacheBlock *findBlock(uint64_t block)
+{
+	cacheBlock *entry = buckets[block % HASH_SIZE];
+
+	while (entry != NULL && entry->block != block)
+		entry = entry->nextInBucket;
+
+	return entry;
+}
+
+/* Frees the least recently used block, writing it back if needed */
+static cacheBlock *evictBlock()
+{
+	cacheBlock *entry = oldest;
+
+	if (entry->valid)
+	{
+		if (entry->dirty && !writeBack(entry))
+			return NULL;
+		hashRemove(entry);
+		entry->valid = 0;
+	}
+
+	return entry;
+}
+
+static int writeBack(cacheBlock *entry)
+{
+	submitWriteBack(entry);
+	return waitWriteBack(entry);
+}
+
+static void submitWriteBack(cacheBlock *entry)
+{
+	entry->request.lba = entry->block * SECTORS_PER_BLOCK;
+	entry->request.count = SECTORS_PER_BLOCK;
+	entry->request.buffer = entry->data;
+	entry->request.operation = ATA_WRITE;
+	ataSubmit(&entry->request);
+}
+
+static int waitWriteBack(cacheBlock *entry)
+{
+	if (!ataWait(&entry->request))
+		return 0;
+
+	entry->dirty = 0;
+	stats.writeBacks++;
+	return 1;
+}
+
+static void touch(cacheBlock *entry)
+{
+	unlink(entry);
+
+	entry->older = newest;
+	entry->newer = NULL;
+	if (newest != NULL)
+		newest->newer = entry;
+	newest = entry;
+	if (oldest == NULL)
+		oldest = entry;
+}
+
+static void unlink(cacheBlock *entry)
+{
+	if (entry->newer != NULL)
+		entry->newer->older = entry->older;
+	else if (newest == entry)
+		newest = entry->older;
+
+	if (entry->older != NULL)
+		entry->older->newer = entry->newer;
+	else if (oldest == entry)
+		oldest = entry->newer;
+
+	entry->older = NULL;
+	entry->newer = NULL;
+}
+
+static void hashInsert(cacheBlock *entry)
+{
+	cacheBlock **bucket = &buckets[entry->block % HASH_SIZE];
+
+	entry->nextInBucket = *bucket;
+	*bucket = entry;
+}
+
+static void hashRemove(cacheBlock *entry)
+{
+	cacheBlock **bucket = &buckets[entry->block % HASH_SIZE];
+
+	while (*bucket != entry)
+		bucket = &(*bucket)->nextInBucket;
+	*bucket = entry->nextInBucket;
+}
@@ -0,0 +1,367 @@
+#include <bmfs.h>
+#include <blockCache.h>
+#include <ataDriver.h>
+#include <scheduler.h>
+#include <pageCache.h>
+#include <lib.h>
+
+#define END_OF_DIRECTORY 0x00
+#define DELETED_ENTRY 0x01
+
+typedef struct
+{
+	int used;
+	int slot;
+	uint64_t position;
+	uint64_t pid;
+} openFile;
+
+static int findFile(const char *name);
+static int freeSlot();
+static uint64_t findFreeBlocks(uint64_t count);
+static int writeDirectory();
+static openFile *getOpenFile(int fd);
+static int closeFile(openFile *file);
+static int createFile(const char *name, uint64_t reservedBlocks);
+static void lockFileSystem();
+static void unlockFileSystem();
+
+static bmfsEntry directory[BMFS_MAX_FILES];
+static openFile openFiles[MAX_OPEN_FILES];
+static uint64_t diskBlocks = 0;
+static int mounted = 0;
+
+/* Disk requests sleep, so the directory and the cache are kept under a
+** lock. Set while a process is inside the file system. */
+static int busy = 0;
+
+int bmfsInitialize()
+{
+	char tag[5] = {0};
+
+	if (!ataInitialize())
+		return 0;
+
+	initializeBlockCache();
+	diskBlocks = ataGetSectorCount() * SECTOR_SIZE / BMFS_BLOCK_SIZE;
+
+	if (cacheRead(BMFS_DISK_INFO, tag, 4) != 4 || strcmpKernel(tag, "BMFS") != 0 ||
+		cacheRead(BMFS_DIRECTORY, directory, sizeof(directory)) != sizeof(directory))
+		return 0;
+
+	mounted = 1;
+	return 1;
+}
+
+/* Reserves space first fit between the files, like the bmfs utility.
+** The first and last blocks of the disk belong to the file system. */
+int bmfsCreate(const char *name, uint64_t reservedBlocks)
+{
+	int slot;
+
+	lockFileSystem();
+	slot = createFile(name, reservedBlocks);
+	unlockFileSystem();
+	return slot;
+}
+
+static int createFile(const char *name, uint64_t reservedBlocks)
+{
+	int slot;
+	uint64_t start;
+
+	if (!mounted || reservedBlocks == 0 || strlenKernel(name) >= BMFS_NAME_LENGTH ||
+		name[0] == END_OF_DIRECTORY || name[0] == DELETED_ENTRY || findFile(name) >= 0)
+		return -1;
+
+	slot = freeSlot();
+	start = findFreeBlocks(reservedBlocks);
+	if (slot < 0 || start == 0)
+		return -1;
+
+	if (directory[slot].name[0] == END_OF_DIRECTORY && slot + 1 < BMFS_MAX_FILES)
+		directory[slot + 1].name[0] = END_OF_DIRECTORY;
+
+	memset(&directory[slot], 0, sizeof(bmfsEntry));
+	strcpyKernel(directory[slot].name, name);
+	directory[slot].startingBlock = start;
+	directory[slot].reservedBlocks = reservedBlocks;
+
+	return writeDirectory() ? slot : -1;
+}
+
+int bmfsDelete(const char *name)
+{
+	int slot, i, result = 0;
+
+	lockFileSystem();
+	slot = findFile(name);
+	for (i = 0; slot >= 0 && i < MAX_OPEN_FILES; i++)
+		if (openFiles[i].used && openFiles[i].slot == slot)
+			slot = -1;
+
+	/* Mapped files can't go either */
+	if (slot >= 0 && !pageCacheDrop(slot))
+		slot = -1;
+
+	if (slot >= 0)
+	{
+		directory[slot].name[0] = DELETED_ENTRY;
+		result = writeDirectory();
+	}
+	unlockFileSystem();
+	return result;
+}
+
+int bmfsOpen(const char *name, int flags)
+{
+	int fd, slot;
+
+	if (!mounted)
+		return -1;
+
+	/* The lock may sleep, so the fd is taken inside it */
+	lockFileSystem();
+	for (fd = 0; fd < MAX_OPEN_FILES && openFiles[fd].used; fd++)
+		;
+	if (fd == MAX_OPEN_FILES)
+	{
+		unlockFileSystem();
+		return -1;
+	}
+	openFiles[fd].used = 1;
+	openFiles[fd].slot = -1;
+	openFiles[fd].pid = getProcessPid(getCurrentProcess());
+
+	slot = findFile(name);
+	if (slot < 0 && (flags & O_CREATE))
+		slot = createFile(name, 1);
+
+	if (slot >= 0 && (flags & O_TRUNCATE) && directory[slot].size != 0)
+	{
+		directory[slot].size = 0;
+		if (!writeDirectory())
+			slot = -1;
+	}
+
+	if (slot < 0)
+		openFiles[fd].used = 0;
+	else
+	{
+		openFiles[fd].slot = slot;
+		openFiles[fd].position = 0;
+	}
+	unlockFileSystem();
+
+	return slot < 0 ? -1 : fd;
+}
+
+int64_t bmfsRead(int fd, void *buffer, uint64_t length)
+{
+	openFile *file = getOpenFile(fd);
+	int64_t read;
+
+	if (file == NULL)
+		return -1;
+
+	read = bmfsReadAt(file->slot, file->position, buffer, length);
+	if (read > 0)
+		file->position += read;
+	return read;
+}
+
+int64_t bmfsWrite(int fd, const void *buffer, uint64_t length)
+{
+	openFile *file = getOpenFile(fd);
+	bmfsEntry *entry;
+	int64_t written;
+
+	if (file == NULL)
+		return -1;
+
+	written = bmfsWriteAt(file->slot, file->position, buffer, length);
+	if (written > 0)
+	{
+		/* Mapped views of the file see the new data right away */
+		pageCacheUpdate(file->slot, file->position, buffer, written);
+
+		entry = &directory[file->slot];
+		file->position += written;
+		if (file->position > entry->size)
+			entry->size = file->position;
+	}
+	return written;
+}
+
+/* The new size goes to the directory and the data to disk on close,
+** along with what was written through mappings of the file */
+int bmfsClose(int fd)
+{
+	openFile *file = getOpenFile(fd);
+
+	if (file == NULL)
+		return 0;
+
+	pageCacheFlush(file->slot);
+	return closeFile(file);
+}
+
+int bmfsGetSlot(int fd)
+{
+	openFile *file = getOpenFile(fd);
+
+	return file == NULL ? -1 : file->slot;
+}
+
+uint64_t bmfsCapacity(int slot)
+{
+	return directory[slot].reservedBlocks * BMFS_BLOCK_SIZE;
+}
+
+/* Reads up to the end of the file */
+int64_t bmfsReadAt(int slot, uint64_t offset, void *buffer, uint64_t length)
+{
+	bmfsEntry *entry = &directory[slot];
+	int64_t read;
+
+	if (offset >= entry->size)
+		return 0;
+	if (length > entry->size - offset)
+		length = entry->size - offset;
+
+	lockFileSystem();
+	read = cacheRead(entry->startingBlock * BMFS_BLOCK_SIZE + offset, buffer, length);
+	unlockFileSystem();
+	return read;
+}
+
+/* Files are contiguous, so a write can't go past the reserved blocks.
+** The size is left to the caller. */
+int64_t bmfsWriteAt(int slot, uint64_t offset, const void *buffer, uint64_t length)
+{
+	bmfsEntry *entry = &directory[slot];
+	uint64_t capacity = bmfsCapacity(slot);
+	int64_t written;
+
+	if (offset >= capacity)
+		return 0;
+	if (length > capacity - offset)
+		length = capacity - offset;
+
+	lockFileSystem();
+	written = cacheWrite(entry->startingBlock * BMFS_BLOCK_SIZE + offset, buffer, length);
+	unlockFileSystem();
+	return written;
+}
+
+int bmfsSync()
+{
+	int result;
+
+	lockFileSystem();
+	result = cacheSync();
+	unlockFileSystem();
+	return result;
+}
+
+/* Closes what a process left open when it is removed. This runs inside
+** the scheduler and can't wait for the disk, the directory is written
+** with the next close. */
+void bmfsCloseAll(uint64_t pid)
+{
+	int fd;
+
+	for (fd = 0; fd < MAX_OPEN_FILES; fd++)
+		if (openFiles[fd].used && openFiles[fd].pid == pid)
+			openFiles[fd].used = 0;
+}
+
+static int closeFile(openFile *file)
+{
+	int result;
+
+	file->used = 0;
+	lockFileSystem();
+	result = writeDirectory() && cacheSync();
+	unlockFileSystem();
+	return result;
+}
+
+static void lockFileSystem()
+{
+	while (busy)
+		sleepOn(&busy);
+	busy = 1;
+	/* Durante el arranque no hay procesos */
+	if (isSchedulerRunning())
+		deferDeletion(getCurrentProcess());
+}
+
+static void unlockFileSystem()
+{
+	busy = 0;
+	wakeUp(&busy);
+	if (isSchedulerRunning())
+		allowDeletion(getCurrentProcess());
+}
+
+static openFile *getOpenFile(int fd)
+{
+	/* slot is -1 while bmfsOpen is still filling it in */
+	if (fd < 0 || fd >= MAX_OPEN_FILES || !openFiles[fd].used || openFiles[fd].slot < 0 ||
+		openFiles[fd].pid != getProcessPid(getCurrentProcess()))
+		return NULL;
+	return &openFiles[fd];
+}
+
+static int findFile(const char *name)
+{
+	int i;
+
+	for (i = 0; i < BMFS_MAX_FILES && directory[i].name[0] != END_OF_DIRECTORY; i++)
+		if (directory[i].name[0] != DELETED_ENTRY && strcmpKernel(directory[i].name, name) == 0)
+			return i;
+
+	return -1;
+}
+
+static int freeSlot()
+{
+	int i;
+
+	for (i = 0; i < BMFS_MAX_FILES; i++)
+		if (directory[i].name[0] == END_OF_DIRECTORY || directory[i].name[0] == DELETED_ENTRY)
+			return i;
+
+	return -1;
+}
+
+/* Returns the first block of a free run of count blocks, or 0 */
+static uint64_t findFreeBlocks(uint64_t count)
+{
+	uint64_t start = 1, end;
+	int i, moved = 1;
+
+	while (moved)
+	{
+		moved = 0;
+		for (i = 0; i < BMFS_MAX_FILES && directory[i].name[0] != END_OF_DIRECTORY; i++)
+		{
+			if (directory[i].name[0] == DELETED_ENTRY)
+				continue;
+			end = directory[i].startingBlock + directory[i].reservedBlocks;
+			if (start < end && directory[i].startingBlock < start + count)
+			{
+				start = end;
+				moved = 1;
+			}
+		}
+	}
+
+	return start + count < diskBlocks ? start : 0;
+}
+
+static int writeDirectory()
+{
+	return cacheWrite(BMFS_DIRECTORY, directory, sizeof(directory)) == sizeof(directory);
+}
@@ -0,0 +1,91 @@
+#include <bootTimer.h>
+#include <videoDriver.h>
+#include <interrupts.h>
+#include <soundDriver.h>
+#include <lib.h>
+
+/* The TSC is measured against PIT channel 2, the one behind the speaker */
+#define PIT_FREQUENCY 1193182
+#define PIT_CHANNEL2 0x42
+#define PIT_COMMAND 0x43
+#define PIT_GATE 0x61
+#define PIT_OUT2 0x20
+#define CALIBRATION_MS 10
+
+static void calibrate();
+
+static const char names[BOOT_PHASES][BOOT_NAME_LENGTH] = {"pure64", "modules", "idt", "speaker", "screen",
+														 "allocator", "paging", "disk", "first process"};
+
+static uint64_t stamps[BOOT_PHASES];
+static uint64_t cyclesPerMicro = 0;
+
+void bootStamp(bootPhase phase)
+{
+	stamps[phase] = readTSC();
+}
+
+/* The counter starts at reset, so the first phase also holds the BIOS */
+int getBootTimes(bootTime *times, int count)
+{
+	int i;
+
+	if (cyclesPerMicro == 0)
+		calibrate();
+
+	for (i = 0; i < count && i < BOOT_PHASES; i++)
+	{
+		strcpyKernel(times[i].name, names[i]);
+		times[i].cycles = i == 0 ? stamps[0] : stamps[i] - stamps[i - 1];
+		times[i].micros = times[i].cycles / cyclesPerMicro;
+	}
+
+	return i;
+}
+
+void printBootReport()
+{
+	bootTime times[BOOT_PHASES];
+	uint64_t total = 0;
+	int i;
+
+	getBootTimes(times, BOOT_PHASES);
+
+	printString("Boot times (us):", 255, 255, 255);
+	for (i = 0; i < BOOT_PHASES; i++)
+	{
+		printString(" ", 255, 255, 255);
+		printString(times[i].name, 255, 255, 255);
+		printString(" ", 255, 255, 255);
+		printDec(times[i].micros);
+		total += times[i].micros;
+	}
+	printString(" total ", 255, 255, 255);
+	printDec(total);
+	newLine();
+}
+
+/* Mode 0 raises OUT2 once the count runs out */
+static void calibrate()
+{
+	uint16_t count = PIT_FREQUENCY / 1000 * CALIBRATION_MS;
+	uint64_t flags = _disableInterrupts(), start;
+	uint8_t gate = inb(PIT_GATE);
+
+	/* Gate on, speaker off */
+	outb(PIT_GATE, (gate & ~0x02) | 0x01);
+	outb(PIT_COMMAND, 0xB0);
+	outb(PIT_CHANNEL2, count & 0xFF);
+	outb(PIT_CHANNEL2, count >> 8);
+
+	start = readTSC();
+	while (!(inb(PIT_GATE) & PIT_OUT2))
+		;
+	cyclesPerMicro = (readTSC() - start) / (CALIBRATION_MS * 1000);
+	if (cyclesPerMicro == 0)
+		cyclesPerMicro = 1;
+
+	outb(PIT_GATE, gate);
+	restartTone();
+	_restoreInterrupts(flags);
+}
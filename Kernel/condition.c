@@ -0,0 +1,82 @@
+#include <stdint.h>
+#include "condition.h"
+#include "lib.h"
+#include "futex.h"
+#include "processes.h"
+#include "scheduler.h"
+
+/* sequence cambia en cada signal, los que esperan duermen sobre el */
+typedef struct condition_t
+{
+	int sequence;
+	char *name;
+} condition_t;
+
+static condition_t *conditions[MAX_CONDITIONS];
+
+condition_t *conditionInit(char *name)
+{
+	int i, empty = -1;
+
+	for (i = 0; i < MAX_CONDITIONS; i++)
+	{
+		if (conditions[i] == NULL)
+		{
+			if (empty < 0)
+				empty = i;
+		}
+		else if (strcmpKernel(name, conditions[i]->name) == 0)
+			return conditions[i];
+	}
+	if (empty < 0)
+		return NULL;
+
+	condition_t *cond = (condition_t *)malloc(sizeof(condition_t));
+	cond->name = (char *)malloc(strlenKernel(name) + 1);
+	strcpyKernel(cond->name, name);
+	cond->sequence = 0;
+	conditions[empty] = cond;
+	return cond;
+}
+
+/* Soltar el mutex y dormir es atomico porque la syscall corre con las
+** interrupciones apagadas. Como con pthreads, puede haber despertares
+** sin signal y hay que volver a mirar la condicion. */
+int conditionWait(condition_t *cond, mutexADT mut)
+{
+	int sequence = cond->sequence;
+
+	mutexUnlock(mut);
+	futexWait(&cond->sequence, sequence);
+	mutexLock(mut);
+	return 0;
+}
+
+int conditionSignal(condition_t *cond)
+{
+	cond->sequence++;
+	return futexWake(&cond->sequence, 1);
+}
+
+int conditionBroadcast(condition_t *cond)
+{
+	cond->sequence++;
+	return futexWake(&cond->sequence, MAX_PROCESSES + MAX_THREADS);
+}
+
+int conditionClose(condition_t *cond)
+{
+	int i;
+
+	for (i = 0; i < MAX_CONDITIONS; i++)
+	{
+		if (conditions[i] == cond)
+		{
+			conditions[i] = NULL;
+			free(cond->name);
+			free(cond);
+			return 0;
+		}
+	}
+	return 1;
+}
@@ -0,0 +1,105 @@
+#include <cpuGroup.h>
+#include <time.h>
+#include <lib.h>
+
+/* Procesos que comparten una cuota de cpu. Los hijos entran en el
+** grupo del padre y los threads usan el de su proceso. */
+struct cpuGroup
+{
+	int members;
+	int percent;
+	uint64_t quota; /* Ticks por periodo */
+	uint64_t used;
+};
+
+static struct cpuGroup *groupOf(process *p);
+
+static struct cpuGroup groups[MAX_CPU_GROUPS];
+static uint64_t periodStart = 0;
+
+void cpuGroupInherit(process *child, process *parent)
+{
+	child->cpuGroup = parent == NULL ? NULL : groupOf(parent);
+	if (child->cpuGroup != NULL)
+		child->cpuGroup->members++;
+}
+
+void cpuGroupLeave(process *p)
+{
+	if (p->cpuGroup != NULL)
+		p->cpuGroup->members--;
+	p->cpuGroup = NULL;
+}
+
+/* Pone a p en un grupo propio limitado a percent de la cpu, sus hijos
+** nuevos entran en el mismo. Con 0 o 100 queda sin limite. */
+int setCpuQuota(process *p, int percent)
+{
+	struct cpuGroup *group = NULL;
+	int i;
+
+	if (p == NULL || p->leader != NULL || percent < 0 || percent > 100)
+		return 0;
+
+	if (percent > 0 && percent < 100)
+	{
+		if (p->cpuGroup != NULL && p->cpuGroup->members == 1)
+			group = p->cpuGroup;
+		else
+		{
+			for (i = 0; i < MAX_CPU_GROUPS && groups[i].members != 0; i++)
+				;
+			if (i == MAX_CPU_GROUPS)
+				return 0;
+			group = &groups[i];
+			group->members = 1;
+			group->used = 0;
+		}
+		group->percent = percent;
+		group->quota = (percent * CPU_PERIOD + 99) / 100;
+	}
+
+	if (group != p->cpuGroup)
+	{
+		cpuGroupLeave(p);
+		p->cpuGroup = group;
+	}
+	return 1;
+}
+
+int getCpuQuota(process *p)
+{
+	struct cpuGroup *group = groupOf(p);
+
+	return group == NULL ? 100 : group->percent;
+}
+
+/* Llamado por el scheduler en cada tick del timer */
+void cpuGroupTick(process *running)
+{
+	struct cpuGroup *group = groupOf(running);
+	uint64_t now = ticks_elapsed();
+	int i;
+
+	if (now - periodStart >= CPU_PERIOD)
+	{
+		periodStart = now;
+		for (i = 0; i < MAX_CPU_GROUPS; i++)
+			groups[i].used = 0;
+	}
+
+	if (group != NULL)
+		group->used++;
+}
+
+int cpuGroupThrottled(process *p)
+{
+	struct cpuGroup *group = groupOf(p);
+
+	return group != NULL && group->used >= group->quota;
+}
+
+static struct cpuGroup *groupOf(process *p)
+{
+	return p->leader != NULL ? p->leader->cpuGroup : p->cpuGroup;
+}
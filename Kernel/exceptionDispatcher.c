@@ -1,13 +1,16 @@
 #include <videoDriver.h>
 #include <stdint.h>
+#include <pageCache.h>
 
 #define ZERO_EXCEPTION_ID 0
 #define INVALID_OP_CODE_EXCEPTION_ID 6
+#define PAGE_FAULT_EXCEPTION_ID 14
 
 static const char * registers[16] = { "RSP: ", "RAX: ", "RBX: ", "RCX: ", "RDX: ", "RBP: ", "RDI: ", "RSI: ", "R8: ", "R9: ", "R10: ", "R11: ", "R12: ", "R13: ", "R14: ", "R15: "};
 
 static void zero_division(uint64_t *states);
 static void invalid_op_code(uint64_t *states);
+static void page_fault(uint64_t *states);
 void printRegisters(uint64_t *states);
 
 void exceptionDispatcher(uint64_t exception, uint64_t *states)
@@ -16,6 +19,14 @@ void exceptionDispatcher(uint64_t exception, uint64_t *states)
 		zero_division(states);
 	else if (exception == INVALID_OP_CODE_EXCEPTION_ID)
 		invalid_op_code(states);
+	else if (exception == PAGE_FAULT_EXCEPTION_ID)
+		page_fault(states);
+}
+
+/* Returns 1 if the fault was a page of a mapped file, now present */
+uint64_t pageFaultDispatcher(uint64_t address, uint64_t error)
+{
+	return pageFault(address);
 }
 
 static void zero_division(uint64_t *states)
@@ -30,6 +41,12 @@ static void invalid_op_code(uint64_t *states)
 	printRegisters(states);
 }
 
+static void page_fault(uint64_t *states)
+{
+	printString("ERROR: Page fault exception.", 255, 255, 255);
+	printRegisters(states);
+}
+
 void printRegisters(uint64_t *states)
 {
 	newLine();
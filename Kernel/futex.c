@@ -0,0 +1,21 @@
+#include <futex.h>
+#include <processes.h>
+#include <scheduler.h>
+
+/* Sleeps while *address holds expected. Syscalls run with interrupts
+** off, so nobody can change it and wake us between the check and the
+** sleep. Returns 0 if the value had already changed. */
+int futexWait(int *address, int expected)
+{
+	if (*address != expected)
+		return 0;
+
+	sleepOn(address);
+	return 1;
+}
+
+/* Wakes up to count waiters, oldest first */
+int futexWake(int *address, int count)
+{
+	return wakeUpSome(address, count);
+}
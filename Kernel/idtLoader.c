@@ -29,18 +29,20 @@ void load_idt()
   //Exceptions
   setup_IDT_entry(0x00, (uint64_t)&_exception0Handler); // Zero Divition
   setup_IDT_entry(0x06, (uint64_t)&_exception1Handler); // Invalid Operation Code
+  setup_IDT_entry(0x0E, (uint64_t)&_pageFaultHandler); // Page Fault
 
   //Interruptions
   setup_IDT_entry(0x20, (uint64_t)&_irq00Handler); // Timer
   setup_IDT_entry(0x21, (uint64_t)&_irq01Handler); // Keyboard
+  setup_IDT_entry(0x2E, (uint64_t)&_irq14Handler); // Primary ATA channel
   setup_IDT_entry(0x70, (uint64_t)&_yield_interrupt); // Yield interrupt
 
   //System Calls
   setup_IDT_entry(0x80, (uint64_t)&_systemCallHandler); // System Call
 
-  //Solo interrupcion timer tick habilitadas
-  picMasterMask(0xFC);
-  picSlaveMask(0xFF);
+  //Timer tick, teclado y la cascada al slave, que solo deja pasar el disco
+  picMasterMask(0xF8);
+  picSlaveMask(0xBF);
 
   _sti();
 }
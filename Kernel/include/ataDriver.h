@@ -0,0 +1,41 @@
+#ifndef ATA_DRIVER_H
+#define ATA_DRIVER_H
+
+#include <stdint.h>
+
+#define SECTOR_SIZE 512
+
+/* Sectors moved by a single command */
+#define ATA_MAX_SECTORS 256
+
+/* diskRequest operations */
+#define ATA_READ 0
+#define ATA_WRITE 1
+#define ATA_FLUSH 2
+
+/* A queued transfer. The buffer must be physically contiguous. */
+typedef struct diskRequest
+{
+	uint64_t lba;
+	uint64_t count;
+	void *buffer;
+	int operation;
+	volatile int done;
+	int result;
+	struct diskRequest *next;
+} diskRequest;
+
+int ataInitialize();
+uint64_t ataGetSectorCount();
+int ataUsesDMA();
+
+void ataSubmit(diskRequest *request);
+int ataWait(diskRequest *request);
+
+int ataRead(uint64_t lba, uint64_t count, void *buffer);
+int ataWrite(uint64_t lba, uint64_t count, const void *buffer);
+int ataFlush();
+
+void ata_handler();
+
+#endif
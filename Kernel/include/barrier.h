@@ -0,0 +1,12 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+#define MAX_BARRIERS 32
+
+typedef struct barrier_t* barrierADT;
+
+barrierADT barrierInit(char *name, int count);
+int barrierWait(barrierADT barrier);
+int barrierClose(barrierADT barrier);
+
+#endif
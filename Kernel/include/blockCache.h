@@ -0,0 +1,29 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include <stdint.h>
+#include <pageAllocator.h>
+
+/* Disk is cached in 4KiB blocks, one 1MB page for blocks and read-ahead */
+#define CACHE_BLOCK_SIZE PAGE_SIZE
+#define READ_AHEAD_BLOCKS 32 /* One ATA_MAX_SECTORS command */
+#define CACHE_BLOCKS ((MB / CACHE_BLOCK_SIZE) - READ_AHEAD_BLOCKS)
+
+/* Read-ahead never crosses a BMFS block */
+#define BMFS_BLOCK_SIZE (2 * MB)
+
+typedef struct
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t readAhead;
+	uint64_t writeBacks;
+} cacheStats;
+
+void initializeBlockCache();
+int64_t cacheRead(uint64_t position, void *buffer, uint64_t length);
+int64_t cacheWrite(uint64_t position, const void *buffer, uint64_t length);
+int cacheSync();
+void getCacheStats(cacheStats *stats);
+
+#endif
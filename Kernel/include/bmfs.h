@@ -0,0 +1,44 @@
+#ifndef BMFS_H
+#define BMFS_H
+
+#include <stdint.h>
+
+/* BareMetal File System, see Bootloader/BMFS/BareMetal File System.md */
+#define BMFS_NAME_LENGTH 32
+#define BMFS_MAX_FILES 64
+#define BMFS_DISK_INFO 1024
+#define BMFS_DIRECTORY 4096
+
+#define MAX_OPEN_FILES 32
+
+/* open flags */
+#define O_CREATE 0x1   /* Creates the file with one block if it is missing */
+#define O_TRUNCATE 0x2 /* Starts the file empty */
+
+typedef struct
+{
+	char name[BMFS_NAME_LENGTH];
+	uint64_t startingBlock;
+	uint64_t reservedBlocks;
+	uint64_t size;
+	uint64_t unused;
+} bmfsEntry;
+
+int bmfsInitialize();
+int bmfsCreate(const char *name, uint64_t reservedBlocks);
+int bmfsDelete(const char *name);
+
+int bmfsOpen(const char *name, int flags);
+int64_t bmfsRead(int fd, void *buffer, uint64_t length);
+int64_t bmfsWrite(int fd, const void *buffer, uint64_t length);
+int bmfsClose(int fd);
+void bmfsCloseAll(uint64_t pid);
+
+/* Used by the page cache, slot is the directory entry of the file */
+int bmfsGetSlot(int fd);
+uint64_t bmfsCapacity(int slot);
+int64_t bmfsReadAt(int slot, uint64_t offset, void *buffer, uint64_t length);
+int64_t bmfsWriteAt(int slot, uint64_t offset, const void *buffer, uint64_t length);
+int bmfsSync();
+
+#endif
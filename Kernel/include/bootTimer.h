@@ -0,0 +1,35 @@
+#ifndef BOOT_TIMER_H
+#define BOOT_TIMER_H
+
+#include <stdint.h>
+
+#define BOOT_NAME_LENGTH 16
+
+/* Each stamp closes the phase with that name, the first one is taken
+** as soon as Pure64 jumps to the kernel */
+typedef enum
+{
+	BOOT_HANDOFF,
+	BOOT_MODULES,
+	BOOT_IDT,
+	BOOT_SPEAKER,
+	BOOT_SCREEN,
+	BOOT_ALLOCATOR,
+	BOOT_PAGING,
+	BOOT_DISK,
+	BOOT_FIRST_PROCESS,
+	BOOT_PHASES
+} bootPhase;
+
+typedef struct
+{
+	char name[BOOT_NAME_LENGTH];
+	uint64_t cycles; /* Since the previous stamp */
+	uint64_t micros;
+} bootTime;
+
+void bootStamp(bootPhase phase);
+void printBootReport();
+int getBootTimes(bootTime *times, int count);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef CONDITION_H
+#define CONDITION_H
+
+#include "mutex.h"
+
+#define MAX_CONDITIONS 32
+
+typedef struct condition_t* conditionADT;
+
+conditionADT conditionInit(char *name);
+int conditionWait(conditionADT cond, mutexADT mut);
+int conditionSignal(conditionADT cond);
+int conditionBroadcast(conditionADT cond);
+int conditionClose(conditionADT cond);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef CPU_GROUP_H
+#define CPU_GROUP_H
+
+#include <processes.h>
+#include <scheduler.h>
+
+/* Cada grupo tiene al menos un proceso, asi que nunca faltan */
+#define MAX_CPU_GROUPS MAX_PROCESSES
+/* Las cuotas se cuentan en ticks de cada CPU_PERIOD */
+#define CPU_PERIOD 10
+
+void cpuGroupInherit(process *child, process *parent);
+void cpuGroupLeave(process *p);
+int setCpuQuota(process *p, int percent);
+int getCpuQuota(process *p);
+void cpuGroupTick(process *running);
+int cpuGroupThrottled(process *p);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <stdint.h>
+
+int futexWait(int *address, int expected);
+int futexWake(int *address, int count);
+
+#endif
@@ -12,15 +12,19 @@
 
 void _irq00Handler(void);
 void _irq01Handler(void);
+void _irq14Handler(void);
 
 void _systemCallHandler(void);
 
 void _exception0Handler(void);
 void _exception1Handler(void);
+void _pageFaultHandler(void);
 
 void _cli(void);
 void _sti(void);
 void _hlt(void);
+uint64_t _disableInterrupts(void);
+void _restoreInterrupts(uint64_t flags);
 
 void picMasterMask(uint8_t mask);
 void picSlaveMask(uint8_t mask);
@@ -0,0 +1,24 @@
+#ifndef IPC_H
+#define IPC_H
+
+#include <stdint.h>
+#include "processes.h"
+
+#define IPC_WORDS 4
+
+#define IPC_IDLE 0
+#define IPC_SENDING 1       /* Queued until the server asks for a request */
+#define IPC_WAITING_REPLY 2
+#define IPC_RECEIVING 3     /* Server blocked in replyAndWait */
+#define IPC_FAILED 4        /* The other side went away */
+
+typedef struct ipcMessage
+{
+	uint64_t word[IPC_WORDS];
+} ipcMessage;
+
+int ipcCall(uint64_t server, const ipcMessage *request, ipcMessage *reply);
+int64_t ipcReplyAndWait(int64_t client, const ipcMessage *reply, ipcMessage *request);
+void ipcAbort(process *p);
+
+#endif
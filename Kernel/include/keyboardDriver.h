@@ -7,5 +7,7 @@
 extern int getKeyCode();
 int getChar();
 void keyboard_handler();
+void waitForKey();
+void wakeUpKeyReaders();
 
 #endif
\ No newline at end of file
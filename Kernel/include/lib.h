@@ -22,8 +22,15 @@ char *cpuVendor(char *result);
 uint64_t getTimeRTC(uint64_t value);
 void speakerOn(uint64_t freq);
 void speakerOff(void);
-void speakerBeep(void);
-void delayLoop(uint64_t times);
+uint8_t inb(uint16_t port);
+void outb(uint16_t port, uint8_t value);
+void insw(uint16_t port, void *buffer, uint64_t count);
+void outsw(uint16_t port, const void *buffer, uint64_t count);
+uint32_t inl(uint16_t port);
+void outl(uint16_t port, uint32_t value);
+void writeCR3(uint64_t pml4);
+void invalidatePage(uint64_t address);
+uint64_t readTSC(void);
 
 
 #endif
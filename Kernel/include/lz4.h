@@ -0,0 +1,11 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <stdint.h>
+
+/* Decodes an LZ4 block (as written by Toolchain/ModulePacker) into
+** destination. Returns the number of bytes written, or -1 if the block
+** is malformed or doesn't fit in destinationSize. */
+int64_t lz4Decompress(const uint8_t *source, uint64_t sourceSize, uint8_t *destination, uint64_t destinationSize);
+
+#endif
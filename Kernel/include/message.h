@@ -1,10 +1,17 @@
 #ifndef MESSAGE_H
 #define MESSAGE_H
 
+//texto de un multicast, lo comparten todas las colas que lo reciben
+struct sharedPayload{
+  int refs;
+  int length;
+};
+
 struct msg{
   int pid;
   char * msg;
   int length;
+  struct sharedPayload * shared; //NULL si el texto esta en el mismo nodo
 };
 
 
@@ -5,10 +5,49 @@
 
 typedef struct queueHeader * messageQueueADT;
 
+/* Lo que puede tener encolado cada proceso. Un mensaje ocupa una
+** pagina, los mas largos se parten en varios. El emisor que el dueño
+** espera en receive o poll puede pasarse hasta completar lo pedido. */
+#define QUEUE_MAX_BYTES 16384
+#define QUEUE_MAX_MESSAGES 16
+
+typedef struct queueStats{
+  int bytes;
+  int messages;
+  int highBytes;      /* Maximos desde que se creo la cola */
+  int highMessages;
+  int blockedSends;   /* Envios que tuvieron que esperar lugar */
+  int rejectedSends;  /* Envios sin espera que no entraban */
+} queueStats;
+
 messageQueueADT newMessageQueue(int pid);
 
-void sendMessage(messageQueueADT queue, int pid, char* text, int length);
+void freeMessageQueue(messageQueueADT queue);
+
+/* Devuelve length, 0 si no espera y no hay lugar, o -1 si no entraria
+** nunca o la cola se cerro mientras esperaba */
+int sendMessage(messageQueueADT queue, int pid, char* text, int length, int block);
+
+int multicastMessage(int* pids, int count, int pid, char* text, int length);
+
+void getQueueStats(messageQueueADT queue, queueStats* stats);
+
+/* Any sender, the bytes still come from a single one */
+#define POLL_ANY -1
+
+/* Both return the sender, tryReceiveMessage -1 if it would wait */
+int receiveMessage(messageQueueADT queue, int pid, char* dest, int length);
+
+int tryReceiveMessage(messageQueueADT queue, int pid, char* dest, int length);
+
+/* Waits until length bytes from pid, or from anyone with POLL_ANY */
+typedef struct pollEntry{
+  int pid;
+  int length;
+  int ready;
+  int sender; /* Who to receive from, -1 if not ready */
+} pollEntry;
 
-void receiveMessage(messageQueueADT queue, int pid, char* dest, int length);
+int pollMessages(messageQueueADT queue, pollEntry* entries, int count, int timeout);
 
 #endif
@@ -4,7 +4,47 @@
 #include <stdint.h>
 #include <lib.h>
 #include <videoDriver.h>
+#include <pageAllocator.h>
 
-void loadModules(void * payloadStart, void ** moduleTargetAddress);
+/* Packed image layout, written by Toolchain/ModulePacker:
+** the module table starts on the page after the kernel binary and every
+** payload starts on a page boundary. */
+#define MODULE_TABLE_MAGIC 0x324B504D /* "MPK2" */
+#define MODULE_NAME_LENGTH 32
 
-#endif
\ No newline at end of file
+/* Modules without a load address are used in place from the image */
+#define MODULE_IN_PLACE 0
+
+/* moduleEntry flags */
+#define MODULE_LZ4 0x1 /* Payload is an LZ4 block of packedSize bytes */
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t count;
+} moduleTable;
+
+typedef struct
+{
+	char name[MODULE_NAME_LENGTH];
+	uint64_t loadAddress;
+	uint32_t offset; /* From the start of the module table */
+	uint32_t size;
+	uint32_t packedSize; /* Bytes of payload in the image */
+	uint32_t checksum; /* Adler-32 of the module contents */
+	uint32_t flags;
+	uint32_t reserved;
+} moduleEntry;
+
+/* Copies (or decompresses) the modules that have a load address and
+** returns the first address past the ones that stay resident in the image. */
+void *loadModules(void *payloadStart);
+uint64_t getPackedSize(void *payloadStart);
+moduleEntry *getModule(const char *name);
+void *getModuleContents(moduleEntry *module);
+/* Copies (or decompresses) a module into destination and verifies it.
+** Returns the module size or -1. */
+int64_t readModule(moduleEntry *module, void *destination);
+int getCorruptModules();
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef PAGEALLOCATOR_H_
 #define PAGEALLOCATOR_H_
 
+#include <stdint.h>
+
 /*Address for size of ram*/
 #define SYSTEM_RAM_ADDRESS 0x1000000
 
@@ -13,21 +15,24 @@
 /*Size of 4k-pages stack*/
 #define PAGE_QTY 511
 
-#define DATA_ADDRESS 0x500000
-/*Ending address for 4k pages*/
-#define MEMORY_PAGES_END ((PAGE_QTY + 1) * PAGE_SIZE + DATA_ADDRESS)
+/*Stacks start past the code module loaded at 0x400000*/
+#define USERLAND_END 0x500000
 
 /*Amount of 1mb processes given*/
 #define MAX_PROCESSES 256
 
-void initializePageAllocator();
+void initializePageAllocator(uint64_t firstFreeAddress);
 uint64_t getAvailablePage();
 void releasePage(uint64_t page);
 uint64_t peekAvailablePage();
+int hasAvailablePage();
 int getIndexInStack();
 uint64_t getAvailableIndex();
 uint64_t getStackPage();
 void releaseStackPage(uint64_t stackpage);
+int isStackPage(uint64_t address);
 uint64_t peekAvailableStackPage();
+int hasStackPage();
+uint64_t stackPagesLeft();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef PAGECACHE_H
+#define PAGECACHE_H
+
+#include <stdint.h>
+#include <paging.h>
+#include <pageAllocator.h>
+
+/* Pages of BMFS files shared by every mapping, one stack page of frames */
+#define PAGE_CACHE_FRAMES (MB / PAGE_SIZE)
+
+/* Each mapping gets its own slice of the window */
+#define MAX_MAPPINGS 32
+#define MAPPING_SIZE (MMAP_WINDOW_SIZE / MAX_MAPPINGS)
+
+void initializePageCache();
+
+uint64_t mmapFile(int fd, uint64_t offset, uint64_t length);
+int msyncFile(uint64_t address, uint64_t length);
+int munmapFile(uint64_t address);
+void unmapProcess(uint64_t pid);
+
+int pageFault(uint64_t address);
+int prefaultRange(uint64_t address, uint64_t length);
+
+void pageCacheUpdate(int slot, uint64_t offset, const void *buffer, uint64_t length);
+int pageCacheFlush(int slot);
+int pageCacheDrop(int slot);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef PAGING_H
+#define PAGING_H
+
+#include <stdint.h>
+
+/* The first 4GiB stay identity mapped with 2MiB pages, framebuffer
+** included. Files are mapped with 4KiB pages in a window above them. */
+#define IDENTITY_GIBS 4
+#define MMAP_WINDOW 0x8000000000
+#define MMAP_WINDOW_SIZE 0x40000000
+
+void initializePaging();
+int mapPage(uint64_t virtual, uint64_t physical);
+int unmapPage(uint64_t virtual);
+int isMapped(uint64_t virtual);
+int clearDirty(uint64_t virtual);
+void releasePageTables(uint64_t virtual, uint64_t length);
+
+#endif
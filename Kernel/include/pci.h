@@ -0,0 +1,26 @@
+#ifndef PCI_H
+#define PCI_H
+
+#include <stdint.h>
+
+/* Configuration space registers */
+#define PCI_COMMAND 0x04
+#define PCI_CLASS 0x08
+#define PCI_BAR4 0x20
+
+#define PCI_COMMAND_IO 0x1
+#define PCI_COMMAND_MASTER 0x4
+
+typedef struct
+{
+	uint8_t bus;
+	uint8_t slot;
+	uint8_t function;
+	uint8_t progIf;
+} pciDevice;
+
+uint32_t pciRead(pciDevice *device, uint8_t offset);
+void pciWrite(pciDevice *device, uint8_t offset, uint32_t value);
+int pciFindClass(uint8_t classCode, uint8_t subclass, pciDevice *device);
+
+#endif
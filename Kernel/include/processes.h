@@ -11,11 +11,39 @@
 #define READY 1
 #define BLOCKED 2
 #define DELETE 3
+#define ZOMBIE 4 /* Terminado, esperando que el padre lo reapee */
+
+/* waitProcess */
+#define WAIT_ANY -1
+#define WNOHANG 1
+/* Exit status de un proceso matado por otro */
+#define KILLED_STATUS -1
 
 #define MAX_DATA_PAGES 64
 #define MAX_PROCESS_NAME 64
 
-typedef struct
+/* Threads run on small stacks carved out of stack pages */
+#define MAX_THREADS 64
+#define THREAD_STACK_SIZE 0x4000
+
+/* A pid is its slot in the process table plus the generation of the
+** slot, so a stale pid never reaches the process that reuses it */
+#define PID_SLOT_BITS 8
+#define PID_SLOT_MASK ((1 << PID_SLOT_BITS) - 1)
+#define PID_GENERATION_BITS 21
+/* The table starts this big and doubles when it fills up */
+#define PROCESS_TABLE_STEP 32
+/* Task ids of threads carry this bit, see getTaskId. A tid is tagged
+** like a pid, with the slot in the threads table. */
+#define THREAD_TASK (1 << 30)
+
+struct program;
+struct ipcMessage;
+struct ioRing;
+struct node;
+struct cpuGroup;
+
+typedef struct process
 {
   char status;
   char name[MAX_PROCESS_NAME];
@@ -23,9 +51,33 @@ typedef struct
   uint64_t stackPage;
   uint64_t dataPageCount;
   void *dataPage[MAX_DATA_PAGES];
+  uint32_t sharedMemory;   /* Shared regions attached, one bit each */
+  struct ioRing *ring;     /* Submission and completion rings, see ring.c */
+  struct node *schedNode;  /* Its entry in the scheduler */
+  struct cpuGroup *cpuGroup; /* CPU quota shared with its children */
   uint64_t pid;
   uint64_t ppid;
   messageQueueADT messageQueue;
+  struct program *program; /* Program image the process runs from, if any */
+  void *waitChannel;       /* What the process sleeps on, see sleepOn */
+  uint64_t sleepTicket;    /* Order in which sleepers are woken */
+  uint64_t wakeTick;       /* Timeout of the sleep, 0 if none */
+  int holdsLocks;          /* Kernel locks held, see deferDeletion */
+  int deletePending;       /* Killed while holding one, dies on release */
+
+  /* Threads share pid, message queue and data pages with their leader */
+  struct process *leader; /* NULL for the process itself */
+  uint64_t tid;
+  uint64_t threads;       /* Live threads of a leader */
+  int exited;             /* Leader out of the scheduler, waiting for its threads */
+  int finished;           /* Thread done, waiting for a join */
+  uint64_t result;        /* Of the thread, or exit status of a process */
+
+  /* Synchronous call/reply, see ipc.c */
+  int ipcState;
+  uint64_t ipcPeer;                    /* Task id of the other side */
+  const struct ipcMessage *ipcRequest; /* Request of a queued caller */
+  struct ipcMessage *ipcBuffer;        /* Where the reply or the next request goes */
 } process;
 
 typedef char status;
@@ -68,6 +120,13 @@ messageQueueADT getMessageQueue(int pid);
 process *createProcess(uint64_t rip, uint64_t argc, uint64_t argv, const char *name);
 void removeProcess(process *p);
 
+process *createThread(uint64_t rip, uint64_t function, uint64_t argument);
+int joinThread(uint64_t tid, uint64_t *result);
+void exitThread(uint64_t result);
+void exitProcess(int status);
+int64_t waitProcess(int64_t pid, int *status, int flags);
+int isThread(process *p);
+
 void setProcessRsp(process *p, uint64_t rsp);
 uint64_t getProcessRsp(process *p);
 
@@ -86,6 +145,10 @@ void setNullAllProcessPages(process *process);
 uint64_t createNewProcessStack(uint64_t rip, uint64_t stackPage, uint64_t argc, uint64_t argv);
 void exitShell();
 process *getProcessByPid(uint64_t pid);
+uint64_t getTaskId(process *p);
+process *getTaskById(uint64_t id);
+uint64_t getTaskSlots();
+process *getTaskBySlot(uint64_t slot);
 int isProcessRunningInForeground();
 
 void setProcessForeground(int pid);
@@ -93,9 +156,14 @@ process *getProcessForeground();
 
 int deleteThisProcess(int pid);
 int deleteProcess(process *p);
+void deferDeletion(process *p);
+void allowDeletion(process *p);
 int isProcessDeleted(process *p);
 
 void addDataPage(process *p, void *page);
+void wakeUp(void *channel);
+int wakeUpSome(void *channel, int count);
+void wakeUpExpired(uint64_t tick);
 
 void printPIDS();
 void whileTrue();
@@ -0,0 +1,44 @@
+#ifndef PROGRAMLOADER_H
+#define PROGRAMLOADER_H
+
+#include <stdint.h>
+#include "processes.h"
+
+/* Header at the start of every program module, filled in by
+** Userland/Programs/program.ld. Offsets are from the start of the image. */
+#define PROGRAM_MAGIC 0x474F5250 /* "PROG" */
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t reserved;
+  uint64_t entry;
+  uint64_t imageSize;
+  uint64_t bssSize;
+  uint64_t relocations;
+  uint64_t relocationsEnd;
+} programHeader;
+
+/* Programs are position independent; the only relocations they carry
+** are R_X86_64_RELATIVE ones for addresses stored in their data. */
+#define R_X86_64_RELATIVE 8
+
+typedef struct
+{
+  uint64_t offset;
+  uint64_t info;
+  int64_t addend;
+} relocation;
+
+/* A loaded program image, shared by every process running code from it */
+typedef struct program
+{
+  uint64_t base;
+  int references;
+} program;
+
+int spawnProgram(const char *name, uint64_t argc, uint64_t argv);
+void setProcessProgram(process *p, program *image);
+void releaseProgram(program *image);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+#include "processes.h"
+
+/* Submission and completion rings share one page with userland.
+** Userland fills sq and moves sqTail, the kernel moves sqHead; the
+** other way around for cq. */
+#define RING_ENTRIES 32
+#define RING_WORKERS 4
+
+typedef struct
+{
+	uint64_t operation; /* System call number */
+	uint64_t argument[5];
+	uint64_t userData;  /* Copied to the completion */
+} ringSubmission;
+
+typedef struct
+{
+	uint64_t userData;
+	uint64_t result;
+} ringCompletion;
+
+typedef struct ioRing
+{
+	volatile uint32_t sqHead;
+	volatile uint32_t sqTail;
+	volatile uint32_t cqHead;
+	volatile uint32_t cqTail;
+	ringSubmission sq[RING_ENTRIES];
+	ringCompletion cq[RING_ENTRIES];
+} ioRing;
+
+ioRing *ringSetup();
+int ringEnter(uint64_t minComplete);
+void ringRelease(process *p);
+
+#endif
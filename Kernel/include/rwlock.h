@@ -0,0 +1,15 @@
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+#define MAX_RWLOCKS 32
+
+typedef struct rwlock_t* rwlockADT;
+
+rwlockADT rwlockInit(char *name);
+int readLock(rwlockADT lock);
+int readUnlock(rwlockADT lock);
+int writeLock(rwlockADT lock);
+int writeUnlock(rwlockADT lock);
+int rwlockClose(rwlockADT lock);
+
+#endif
@@ -6,16 +6,62 @@
 #include "genericQueue.h"
 #include "defs.h"
 
-#define MAX_PROCESSES 32
+/* Tamaño maximo de la tabla, uno por stack page (ver pageAllocator.h) */
+#define MAX_PROCESSES 256
 #define QUANTUM 1
 
+/* Politicas, de menor a mayor prioridad */
+#define SCHED_FAIR 0
+#define SCHED_FIFO 1
+#define SCHED_DEADLINE 2
+
+#define MIN_RT_PRIORITY 1
+#define MAX_RT_PRIORITY 99
+
+/* Los procesos de tiempo real usan a lo sumo RT_LIMIT de cada RT_WINDOW
+** ticks, asi uno que no se bloquea nunca no cuelga al shell */
+#define RT_WINDOW 18
+#define RT_LIMIT 16
+/* Utilizacion maxima de las tareas EDF, en milesimos */
+#define RT_UTILIZATION 900
+
+/* Un despertado de la ronda desaloja al actual si corrio al menos
+** WAKEUP_GRANULARITY ticks menos que el */
+#define SLEEPER_CREDIT 2
+#define WAKEUP_GRANULARITY 1
+
+typedef struct schedAttr
+{
+	int policy;
+	int priority;     /* SCHED_FIFO */
+	uint64_t runtime; /* SCHED_DEADLINE, ticks por periodo */
+	uint64_t period;
+} schedAttr;
+
 typedef struct node
 {
 	int quantum;
 	process *p;
 	struct node *next;
+	struct schedClass *class;
+	schedAttr attr;
+	uint64_t order;     /* Turno dentro de la misma prioridad FIFO */
+	uint64_t remaining; /* Lo que le queda del periodo EDF */
+	uint64_t deadline;  /* Fin del periodo EDF actual */
+	uint64_t vruntime;  /* Ticks corridos en la ronda */
 } nodeList;
 
+/* Cada clase maneja sus procesos listos, el scheduler le pide el
+** siguiente a cada una en orden de prioridad */
+typedef struct schedClass
+{
+	void (*enqueue)(nodeList *node);
+	void (*dequeue)(nodeList *node);
+	nodeList *(*pickNext)();     /* NULL si no tiene ninguno listo */
+	void (*tick)(nodeList *running); /* En cada tick, running NULL si corre otra clase */
+	void (*yield)(nodeList *node);
+} schedClass;
+
 typedef struct blockedProcess
 {
 	process* process;
@@ -32,12 +78,22 @@ uint64_t nextProcess(uint64_t current_rsp);
 uint64_t runProcess(process * new_process);
 void killProcess();
 void yieldProcess();
+void switchToProcess(process *p);
+int yieldTo(process *p);
+void sleepOn(void *channel);
+void sleepOnUntil(void *channel, uint64_t tick);
+int isSchedulerRunning();
 
 void _changeProcess(uint64_t rsp);
 void _yieldProcess();
 
 process * getCurrentProcess();
 
+void wakeUpPreempt(process *p);
+void preemptIfNeeded();
+int setSchedAttr(process *p, schedAttr *attr);
+int getSchedAttr(process *p, schedAttr *attr);
+
 void increaseQuantum();
 void decreaseQuantum();
 
@@ -0,0 +1,16 @@
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <stdint.h>
+#include "processes.h"
+
+/* Regions up to a page take a page, bigger ones a whole stack page */
+#define MAX_SHM_REGIONS 16
+#define MAX_SHM_NAME 32
+#define MAX_SHM_SIZE MB
+
+void *shmOpen(const char *name, uint64_t size);
+int shmClose(void *address);
+void shmReleaseProcess(process *p);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef SOUND_DRIVER_H
+#define SOUND_DRIVER_H
+
+#include <stdint.h>
+
+#define TONE_QUEUE_SIZE 32
+
+/* The old boot beep: divisor 0xC80 of the PIT */
+#define BEEP_FREQUENCY 373
+#define BEEP_MILLIS 100
+
+int playTone(uint32_t frequency, uint32_t millis);
+void restartTone();
+void sound_handler();
+
+#endif
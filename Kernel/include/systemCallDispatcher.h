@@ -0,0 +1,16 @@
+#ifndef SYSTEM_CALL_DISPATCHER_H
+#define SYSTEM_CALL_DISPATCHER_H
+
+#include <stdint.h>
+
+/* Numbers of the calls that other kernel code has to tell apart */
+#define SYS_KILL 14
+#define SYS_THREAD_EXIT 34
+#define SYS_RING_SETUP 58
+#define SYS_RING_ENTER 59
+#define SYS_EXIT 67
+#define SYS_WAITPID 68
+
+uint64_t systemCallDispatcher(uint64_t rdi, uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+
+#endif
@@ -6,5 +6,7 @@ int ticks_elapsed();
 int seconds_elapsed();
 void seconds_delay(int seconds);
 void ticks_delay(int ticks);
+int millis_to_ticks(int millis);
+int ticks_to_millis(int ticks);
 
 #endif
\ No newline at end of file
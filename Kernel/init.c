@@ -3,11 +3,15 @@
 #include "videoDriver.h"
 #include "processes.h"
 #include "lib.h"
+#include "bootTimer.h"
 
 static void *const sampleCodeModuleAddress = (void *)0x400000;
 
 void init()
 {
+	bootStamp(BOOT_FIRST_PROCESS);
+	printBootReport();
+
 	process *shell = createProcess((uint64_t)sampleCodeModuleAddress, 0,0, "shell");
 	setProcessForeground(shell->pid);
 	runProcess(shell);
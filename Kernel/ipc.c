@@ -0,0 +1,122 @@
+#include <ipc.h>
+#include <scheduler.h>
+#include <lib.h>
+
+static process *oldestCaller(uint64_t server);
+
+/* Order of the queued callers */
+static uint64_t callTickets = 0;
+
+/* Sends request to a process or thread and blocks until it replies.
+** If the server is already waiting the request is copied straight into
+** its buffer and the caller gives it the cpu, without waiting for the
+** round robin to get there. Returns -1 if the server is gone. */
+int ipcCall(uint64_t serverId, const ipcMessage *request, ipcMessage *reply)
+{
+	process *client = getCurrentProcess();
+	process *server = getTaskById(serverId);
+	int state;
+
+	if (server == NULL || server == client)
+		return -1;
+
+	client->ipcPeer = serverId;
+	client->ipcBuffer = reply;
+	blockProcess(client);
+
+	if (server->ipcState == IPC_RECEIVING)
+	{
+		*server->ipcBuffer = *request;
+		server->ipcPeer = getTaskId(client);
+		server->ipcState = IPC_IDLE;
+		client->ipcState = IPC_WAITING_REPLY;
+		unblockProcess(server);
+		switchToProcess(server);
+	}
+	else
+	{
+		client->ipcRequest = request;
+		client->ipcState = IPC_SENDING;
+		client->sleepTicket = ++callTickets;
+		yieldProcess();
+	}
+
+	state = client->ipcState;
+	client->ipcState = IPC_IDLE;
+	return state == IPC_FAILED ? -1 : 0;
+}
+
+/* Replies to client, if it isn't negative, and takes the next request.
+** Queued callers are served first; otherwise the server blocks and the
+** client it just answered runs right away. Returns the id of the caller
+** to reply to next. */
+int64_t ipcReplyAndWait(int64_t clientId, const ipcMessage *reply, ipcMessage *request)
+{
+	process *server = getCurrentProcess(), *client = NULL, *caller;
+	uint64_t serverId = getTaskId(server);
+
+	if (clientId >= 0)
+	{
+		client = getTaskById(clientId);
+		if (client != NULL && client->ipcState == IPC_WAITING_REPLY && client->ipcPeer == serverId)
+		{
+			*client->ipcBuffer = *reply;
+			client->ipcState = IPC_IDLE;
+			unblockProcess(client);
+		}
+		else
+			client = NULL;
+	}
+
+	if ((caller = oldestCaller(serverId)) != NULL)
+	{
+		*request = *caller->ipcRequest;
+		caller->ipcState = IPC_WAITING_REPLY;
+		return getTaskId(caller);
+	}
+
+	server->ipcBuffer = request;
+	server->ipcState = IPC_RECEIVING;
+	blockProcess(server);
+	if (client != NULL)
+		switchToProcess(client);
+	else
+		yieldProcess();
+
+	return server->ipcPeer;
+}
+
+/* Called when p leaves the scheduler, fails the calls waiting on it */
+void ipcAbort(process *p)
+{
+	uint64_t id = getTaskId(p), i;
+	process *client;
+
+	p->ipcState = IPC_IDLE;
+	for (i = 0; i < getTaskSlots(); i++)
+	{
+		client = getTaskBySlot(i);
+		if (client != NULL && client->ipcPeer == id &&
+			(client->ipcState == IPC_SENDING || client->ipcState == IPC_WAITING_REPLY))
+		{
+			client->ipcState = IPC_FAILED;
+			unblockProcess(client);
+		}
+	}
+}
+
+static process *oldestCaller(uint64_t serverId)
+{
+	process *p, *oldest = NULL;
+	uint64_t i;
+
+	for (i = 0; i < getTaskSlots(); i++)
+	{
+		p = getTaskBySlot(i);
+		if (p != NULL && !isProcessDeleted(p) && p->ipcState == IPC_SENDING && p->ipcPeer == serverId &&
+			(oldest == NULL || p->sleepTicket < oldest->sleepTicket))
+			oldest = p;
+	}
+
+	return oldest;
+}
@@ -1,22 +1,35 @@
 #include <stdint.h>
 #include <time.h>
 #include <keyboardDriver.h>
+#include <ataDriver.h>
+#include <soundDriver.h>
+#include <processes.h>
 
 static void int_20();
 static void int_21();
-static void (*ints[])() = {int_20, int_21};
+static void int_2E();
+static void (*ints[])() = {int_20, int_21, 0, 0, 0, 0, 0, 0,
+						   0, 0, 0, 0, 0, 0, int_2E, 0};
 
 void irqDispatcher(uint64_t irq)
 {
-	(*ints[irq])();
+	if (ints[irq] != 0)
+		(*ints[irq])();
 }
 
 static void int_20()
 {
 	timer_handler();
+	sound_handler();
+	wakeUpExpired(ticks_elapsed());
 }
 
 static void int_21()
 {
 	keyboard_handler();
-}
\ No newline at end of file
+}
+
+static void int_2E()
+{
+	ata_handler();
+}
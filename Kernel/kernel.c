@@ -7,6 +7,11 @@
 #include <scheduler.h>
 #include <pageAllocator.h>
 #include <init.h>
+#include <bmfs.h>
+#include <paging.h>
+#include <pageCache.h>
+#include <bootTimer.h>
+#include <soundDriver.h>
 
 extern uint8_t text;
 extern uint8_t rodata;
@@ -17,8 +22,8 @@ extern uint8_t endOfKernel;
 
 static const uint64_t PageSize = 0x1000;
 
-static void *const sampleCodeModuleAddress = (void *)0x400000;
-static void *const sampleDataModuleAddress = (void *)0x500000;
+/* Kernel image plus the modules used in place from it */
+static void *endOfResidentImage;
 
 typedef int (*EntryPoint)();
 
@@ -27,19 +32,33 @@ void clearBSS(void *bssAddress, uint64_t bssSize)
 	memset(bssAddress, 0, bssSize);
 }
 
+/* Pure64 loads the binary without .bss, so the module table lies where
+** .bss starts. It moves past endOfKernel before .bss is cleared, copied
+** from the end because both areas can overlap. */
+static void *moveModules()
+{
+	uint64_t *source = (uint64_t *)&endOfKernelBinary;
+	uint64_t *destination = (uint64_t *)&endOfKernel;
+	uint64_t words = (getPackedSize(source) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	while (words-- > 0)
+		destination[words] = source[words];
+	return destination;
+}
+
 void *getStackBase()
 {
-	return (void *)((uint64_t)&endOfKernel + PageSize * 8 - sizeof(uint64_t));
+	return (void *)((uint64_t)endOfResidentImage + PageSize * 8 - sizeof(uint64_t));
 }
 
 void *initializeKernelBinary()
 {
-	void *moduleAddresses[] = {
-		sampleCodeModuleAddress,
-		sampleDataModuleAddress};
+	void *modules = moveModules();
 
-	loadModules(&endOfKernelBinary, moduleAddresses);
 	clearBSS(&bss, &endOfKernel - &bss);
+	bootStamp(BOOT_HANDOFF);
+	endOfResidentImage = loadModules(modules);
+	bootStamp(BOOT_MODULES);
 
 	return getStackBase();
 }
@@ -47,13 +66,27 @@ void *initializeKernelBinary()
 int main()
 {
 	load_idt();
-	speakerBeep();
+	bootStamp(BOOT_IDT);
+	playTone(BEEP_FREQUENCY, BEEP_MILLIS);
+	bootStamp(BOOT_SPEAKER);
 	printBackGround();
-	initializePageAllocator();
-
-	process *shell = createProcess((uint64_t)sampleCodeModuleAddress, 0,0, "shell");
-	setProcessForeground(shell->pid);
-	runProcess(shell);
+	bootStamp(BOOT_SCREEN);
+	initializePageAllocator((uint64_t)endOfResidentImage);
+	bootStamp(BOOT_ALLOCATOR);
+	initializePaging();
+	initializePageCache();
+	bootStamp(BOOT_PAGING);
+
+	if (getCorruptModules() > 0)
+		printString("WARNING: module checksum mismatch\n", 255, 0, 0);
+
+	if (!bmfsInitialize())
+		printString("WARNING: no BMFS disk, files are unavailable\n", 255, 0, 0);
+	bootStamp(BOOT_DISK);
+
+	/* init (pid 0) crea el shell y queda como proceso ocioso, asi siempre
+	** hay alguien listo mientras los demas esperan al disco */
+	runProcess(createProcess((uint64_t)init, 0, 0, "init"));
 
 	while (1)
 	{
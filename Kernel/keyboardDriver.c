@@ -1,4 +1,6 @@
 #include <keyboardDriver.h>
+#include <processes.h>
+#include <scheduler.h>
 
 #define IS_ALPHA(C) (C >= 'a' && C <= 'z')
 
@@ -125,6 +127,7 @@ void keyboard_handler()
       {
         readIndex = (readIndex + 1) % BUFFER_SIZE;
       }
+      wakeUpKeyReaders();
     }
   }
 }
@@ -141,3 +144,15 @@ int getChar()
   elements--;
   return c;
 }
+
+/* Duerme al proceso actual hasta la proxima tecla o hasta que cambie el
+** foreground. Quien llama vuelve a chequear con getChar. */
+void waitForKey()
+{
+  sleepOn(buffer);
+}
+
+void wakeUpKeyReaders()
+{
+  wakeUp(buffer);
+}
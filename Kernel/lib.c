@@ -16,17 +16,13 @@ void *malloc(uint64_t size)
 
 void free(void *page)
 {
-	if ((uint64_t)page < MEMORY_PAGES_END)
-	{
-		releasePage((uint64_t)page);
-	}
-	else if ((uint64_t)page > MEMORY_PAGES_END)
+	if (isStackPage((uint64_t)page))
 	{
 		releaseStackPage((uint64_t)page);
 	}
 	else
 	{
-		printString("Error in freeing memory\n", 0, 0, 255);
+		releasePage((uint64_t)page);
 	}
 }
 
@@ -38,34 +34,29 @@ void *memcpy(void *destination, const void *source, uint64_t length)
 	* forwards. (Don't change this without adjusting memmove.)
 	*
 	* For speedy copying, optimize the common case where both pointers
-	* and the length are word-aligned, and copy word-at-a-time instead
-	* of byte-at-a-time. Otherwise, copy by bytes.
-	*
-	* The alignment logic below should be portable. We rely on
-	* the compiler to be reasonably intelligent about optimizing
-	* the divides and modulos out. Fortunately, it is.
+	* are word-aligned, and copy word-at-a-time instead of
+	* byte-at-a-time. The tail that doesn't fill a word, or the whole
+	* buffer when the pointers are misaligned, is copied by bytes.
 	*/
-	uint64_t i;
+	uint64_t i = 0;
+	uint8_t *d = (uint8_t *)destination;
+	const uint8_t *s = (const uint8_t *)source;
 
-	if ((uint64_t)destination % sizeof(uint32_t) == 0 &&
-			(uint64_t)source % sizeof(uint32_t) == 0 &&
-			length % sizeof(uint32_t) == 0)
+	if ((uint64_t)destination % sizeof(uint64_t) == 0 &&
+			(uint64_t)source % sizeof(uint64_t) == 0)
 	{
-		uint32_t *d = (uint32_t *)destination;
-		const uint32_t *s = (const uint32_t *)source;
+		uint64_t *dw = (uint64_t *)destination;
+		const uint64_t *sw = (const uint64_t *)source;
 
-		for (i = 0; i < length / sizeof(uint32_t); i++)
-			d[i] = s[i];
-	}
-	else
-	{
-		uint8_t *d = (uint8_t *)destination;
-		const uint8_t *s = (const uint8_t *)source;
+		for (; i < length / sizeof(uint64_t); i++)
+			dw[i] = sw[i];
 
-		for (i = 0; i < length; i++)
-			d[i] = s[i];
+		i *= sizeof(uint64_t);
 	}
 
+	for (; i < length; i++)
+		d[i] = s[i];
+
 	return destination;
 }
 
@@ -0,0 +1,71 @@
+#include <lz4.h>
+#include <lib.h>
+
+#define MIN_MATCH 4
+
+static int readLength(const uint8_t **ip, const uint8_t *end, uint64_t *length);
+
+/* Single pass over the block: each sequence is a token, its literals
+** and an offset back into the output for the match that follows. */
+int64_t lz4Decompress(const uint8_t *source, uint64_t sourceSize, uint8_t *destination, uint64_t destinationSize)
+{
+	const uint8_t *ip = source;
+	const uint8_t *end = source + sourceSize;
+	uint8_t *op = destination;
+	uint8_t *opEnd = destination + destinationSize;
+
+	while (ip < end)
+	{
+		uint8_t token = *ip++;
+		uint64_t length = token >> 4;
+
+		if (length == 15 && !readLength(&ip, end, &length))
+			return -1;
+		if (length > (uint64_t)(end - ip) || length > (uint64_t)(opEnd - op))
+			return -1;
+
+		memcpy(op, ip, length);
+		ip += length;
+		op += length;
+
+		/* The last sequence has literals only */
+		if (ip == end)
+			break;
+
+		if (end - ip < 2)
+			return -1;
+		uint64_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (uint64_t)(op - destination))
+			return -1;
+
+		length = token & 0x0F;
+		if (length == 15 && !readLength(&ip, end, &length))
+			return -1;
+		length += MIN_MATCH;
+		if (length > (uint64_t)(opEnd - op))
+			return -1;
+
+		/* Matches may overlap their own output, so copy forwards by bytes */
+		const uint8_t *match = op - offset;
+		while (length--)
+			*op++ = *match++;
+	}
+
+	return op - destination;
+}
+
+static int readLength(const uint8_t **ip, const uint8_t *end, uint64_t *length)
+{
+	uint8_t byte;
+
+	do
+	{
+		if (*ip >= end)
+			return 0;
+		byte = *(*ip)++;
+		*length += byte;
+	} while (byte == 255);
+
+	return 1;
+}
@@ -4,14 +4,27 @@
 #include "include/lib.h"
 #include "include/scheduler.h"
 #include <videoDriver.h>
+#include <time.h>
+#include <pageAllocator.h>
 
 
+//un receive o poll dormido en la cola, uno por thread del dueño
+typedef struct receiver{
+  uint64_t task;
+  pollEntry * entries; //NULL si esta libre
+  int count;
+} receiver;
+
+#define MAX_RECEIVERS (MAX_THREADS + 1)
+
 struct queueHeader{
   int ownerPid;
   struct messageNode * first;
   struct messageNode * last;
-  int waitingForPid;
-  int messageSize;
+  int blockedSenders;
+  int closed; //el dueño murio, el ultimo que espera la libera
+  receiver receivers[MAX_RECEIVERS];
+  queueStats stats;
 };
 
 struct messageNode{
@@ -20,6 +33,25 @@ struct messageNode{
   struct msg * message;
 };
 
+//nodo, mensaje y texto van juntos en una pagina
+#define MESSAGE_CHUNK ((int)(PAGE_SIZE - sizeof(struct messageNode) - sizeof(struct msg)))
+
+//el texto compartido va en su propia pagina detras del encabezado
+#define SHARED_CHUNK ((int)(PAGE_SIZE - sizeof(struct sharedPayload)))
+
+static int hasRoom(messageQueueADT queue, int pid, int length);
+static int queuedFrom(messageQueueADT queue, int pid);
+static int waitForRoom(messageQueueADT queue, int pid, int length, int *waited);
+static void enqueueMessage(messageQueueADT queue, int pid, char * text, int length);
+static void enqueueShared(messageQueueADT queue, int pid, struct sharedPayload * shared);
+static void linkMessage(messageQueueADT queue, struct messageNode * newNode);
+static void releaseMessage(struct messageNode * node);
+static void releaseShared(struct sharedPayload * shared);
+static int readySender(messageQueueADT queue, int pid, int length);
+static void awaitSenders(messageQueueADT queue, pollEntry * entries, int count);
+static void stopAwaiting(messageQueueADT queue);
+static int isAwaited(messageQueueADT queue, int pid);
+
 
 int isMessageAvailable(struct messageNode * curr, int pid, int length){
   int aux = 0;
@@ -46,14 +78,14 @@ struct messageNode * searchMessageR(struct messageNode* curr, messageQueueADT qu
       dest += curr->message->length;
 
       struct messageNode * aux = searchMessageR(curr->tail, queue, prev, pid, length, dest);
-      free(curr->message->msg);
-      free(curr->message);
-      free(curr);
+      releaseMessage(curr);
+      queue->stats.messages--;
       return aux;
 
     }else{
+      //el texto puede ser compartido, se avanza sin moverlo
       memcpy(dest, curr->message->msg, length);
-      memcpy(curr->message->msg, curr->message->msg+length, curr->message->length-length);
+      curr->message->msg += length;
       curr->message->length -= length;
       return curr;
     }
@@ -69,29 +101,257 @@ struct messageNode * searchMessageR(struct messageNode* curr, messageQueueADT qu
 
 void searchMessage(messageQueueADT queue, int pid, int length, char* dest){
   queue->first = searchMessageR(queue->first, queue,  NULL, pid, length, dest);
+  queue->stats.bytes -= length;
+  if(queue->blockedSenders > 0){
+    wakeUp(&queue->stats);
+  }
 }
 
 messageQueueADT newMessageQueue(int pid){
   struct queueHeader* newQueue = malloc(sizeof(struct queueHeader));
+  int i;
+
   newQueue->ownerPid = pid;
   newQueue->first = NULL;
   newQueue->last = NULL;
-  newQueue->waitingForPid = -1;
+  newQueue->blockedSenders = 0;
+  newQueue->closed = 0;
+  for(i = 0; i < MAX_RECEIVERS; i++){
+    newQueue->receivers[i].entries = NULL;
+  }
+  memset(&newQueue->stats, 0, sizeof(queueStats));
   return (messageQueueADT)newQueue;
 }
 
-void sendMessage(messageQueueADT queue, int pid, char * text, int length){
+//si hay procesos esperando para enviar, se libera cuando sale el ultimo
+void freeMessageQueue(messageQueueADT queue){
+  struct messageNode * next;
 
-  char * message = malloc(length);
-  memcpy(message, text, length);
-  struct messageNode *newNode = malloc(sizeof(struct messageNode));
-  newNode->tail = NULL;
-  newNode->head = queue->last;
-  newNode->message = malloc(sizeof(struct msg));
+  for(; queue->first != NULL; queue->first = next){
+    next = queue->first->tail;
+    releaseMessage(queue->first);
+  }
+  queue->stats.bytes = 0;
+  queue->stats.messages = 0;
+
+  if(queue->blockedSenders == 0){
+    free(queue);
+  }else{
+    queue->closed = 1;
+    wakeUp(&queue->stats);
+  }
+}
+
+/* Sin lugar, con block espera a que el receptor saque mensajes. Los
+** mensajes largos entran de a partes, el receptor igual lee bytes. Sin
+** block el lugar se chequea una vez para todo el mensaje y no espera. */
+int sendMessage(messageQueueADT queue, int pid, char * text, int length, int block){
+  int sent = 0, chunk, waited = 0;
+
+  if(length <= 0){
+    return 0;
+  }
+  if(!block && !hasRoom(queue, pid, length)){
+    queue->stats.rejectedSends++;
+    return length > QUEUE_MAX_BYTES ? -1 : 0;
+  }
+
+  while(sent < length){
+    chunk = length - sent < MESSAGE_CHUNK ? length - sent : MESSAGE_CHUNK;
+
+    if(block && !waitForRoom(queue, pid, chunk, &waited)){
+      return -1;
+    }
+
+    enqueueMessage(queue, pid, text + sent, chunk);
+    sent += chunk;
+  }
+
+  return length;
+}
+
+/* Manda lo mismo a todos los pids con una sola copia del texto: cada
+** cola recibe una referencia. Devuelve a cuantos les llego entero. */
+int multicastMessage(int * pids, int count, int pid, char * text, int length){
+  struct sharedPayload * shared;
+  messageQueueADT queue;
+  int sent, chunk, i, waited, reached = 0;
+  int failed[MAX_PROCESSES];
+
+  if(length <= 0 || count <= 0 || count > MAX_PROCESSES){
+    return 0;
+  }
+  for(i = 0; i < count; i++){
+    failed[i] = 0;
+  }
+
+  for(sent = 0; sent < length; sent += chunk){
+    chunk = length - sent < SHARED_CHUNK ? length - sent : SHARED_CHUNK;
+
+    shared = malloc(sizeof(struct sharedPayload) + chunk);
+    shared->refs = count;
+    shared->length = chunk;
+    memcpy(shared + 1, text + sent, chunk);
+
+    for(i = 0; i < count; i++){
+      //se busca de nuevo cada vez, la cola pudo cerrarse mientras esperaba
+      waited = 0;
+      if(failed[i] || getProcessByPid(pids[i]) == NULL ||
+         !waitForRoom(queue = getMessageQueue(pids[i]), pid, chunk, &waited)){
+        failed[i] = 1;
+        releaseShared(shared);
+      }else{
+        enqueueShared(queue, pid, shared);
+      }
+    }
+  }
+
+  for(i = 0; i < count; i++){
+    reached += !failed[i];
+  }
+  return reached;
+}
+
+void getQueueStats(messageQueueADT queue, queueStats* stats){
+  *stats = queue->stats;
+}
+
+/* Con la cola llena igual pasa el emisor al que el dueño esta esperando,
+** hasta completar lo que pidio. Si no, los mensajes de otro que llenaron
+** la cola no se leen nunca y los dos quedan esperando. */
+static int hasRoom(messageQueueADT queue, int pid, int length){
+  int messages = (length + MESSAGE_CHUNK - 1) / MESSAGE_CHUNK;
+  if(queue->stats.bytes + length <= QUEUE_MAX_BYTES &&
+     queue->stats.messages + messages <= QUEUE_MAX_MESSAGES){
+    return 1;
+  }
+  return isAwaited(queue, pid);
+}
+
+//algun receive o poll dormido espera mas bytes de pid que los encolados
+static int isAwaited(messageQueueADT queue, int pid){
+  receiver * r;
+  pollEntry * e;
+  int i, j;
+
+  for(i = 0; i < MAX_RECEIVERS; i++){
+    r = &queue->receivers[i];
+    //si lo mataron mientras dormia el lugar quedo sin liberar
+    if(r->entries == NULL || getTaskById(r->task) == NULL){
+      continue;
+    }
+    for(j = 0; j < r->count; j++){
+      e = &r->entries[j];
+      if((e->pid == pid || e->pid == POLL_ANY) &&
+         queuedFrom(queue, pid) < (e->length > 0 ? e->length : 1)){
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+//anota lo que espera el thread actual y despierta a los emisores trabados
+static void awaitSenders(messageQueueADT queue, pollEntry * entries, int count){
+  uint64_t task = getTaskId(getCurrentProcess());
+  receiver * r, * slot = NULL;
+  int i;
+
+  for(i = 0; i < MAX_RECEIVERS; i++){
+    r = &queue->receivers[i];
+    if(r->entries != NULL && r->task == task){
+      slot = r;
+      break;
+    }
+    if(slot == NULL && (r->entries == NULL || getTaskById(r->task) == NULL)){
+      slot = r;
+    }
+  }
+  if(slot != NULL){
+    slot->task = task;
+    slot->entries = entries;
+    slot->count = count;
+  }
+
+  if(queue->blockedSenders > 0){
+    wakeUp(&queue->stats);
+  }
+}
+
+static void stopAwaiting(messageQueueADT queue){
+  uint64_t task = getTaskId(getCurrentProcess());
+  int i;
+
+  for(i = 0; i < MAX_RECEIVERS; i++){
+    if(queue->receivers[i].entries != NULL && queue->receivers[i].task == task){
+      queue->receivers[i].entries = NULL;
+    }
+  }
+}
+
+static int queuedFrom(messageQueueADT queue, int pid){
+  struct messageNode * curr;
+  int bytes = 0;
+
+  for(curr = queue->first; curr != NULL; curr = curr->tail){
+    if(curr->message->pid == pid){
+      bytes += curr->message->length;
+    }
+  }
+  return bytes;
+}
+
+//devuelve 0 si la cola se cerro mientras esperaba
+static int waitForRoom(messageQueueADT queue, int pid, int length, int *waited){
+  if(hasRoom(queue, pid, length)){
+    return 1;
+  }
+  if(!*waited){
+    queue->stats.blockedSends++;
+    *waited = 1;
+  }
+
+  queue->blockedSenders++;
+  while(!queue->closed && !hasRoom(queue, pid, length)){
+    sleepOn(&queue->stats);
+  }
+  queue->blockedSenders--;
+
+  if(queue->closed){
+    if(queue->blockedSenders == 0){
+      free(queue);
+    }
+    return 0;
+  }
+  return 1;
+}
+
+static void enqueueMessage(messageQueueADT queue, int pid, char * text, int length){
+  struct messageNode *newNode = malloc(sizeof(struct messageNode) + sizeof(struct msg) + length);
+  newNode->message = (struct msg *)(newNode + 1);
   newNode->message->pid = pid;
-  newNode->message->msg = message;
+  newNode->message->msg = (char *)(newNode->message + 1);
   newNode->message->length = length;
+  newNode->message->shared = NULL;
+  memcpy(newNode->message->msg, text, length);
+  linkMessage(queue, newNode);
+}
+
+static void enqueueShared(messageQueueADT queue, int pid, struct sharedPayload * shared){
+  struct messageNode *newNode = malloc(sizeof(struct messageNode) + sizeof(struct msg));
+  newNode->message = (struct msg *)(newNode + 1);
+  newNode->message->pid = pid;
+  newNode->message->msg = (char *)(shared + 1);
+  newNode->message->length = shared->length;
+  newNode->message->shared = shared;
+  linkMessage(queue, newNode);
+}
 
+static void linkMessage(messageQueueADT queue, struct messageNode * newNode){
+  int length = newNode->message->length;
+
+  newNode->tail = NULL;
+  newNode->head = queue->last;
   if(queue->first == NULL){
     queue->first = newNode;
     queue->last = newNode;
@@ -100,24 +360,95 @@ void sendMessage(messageQueueADT queue, int pid, char * text, int length){
     queue->last = newNode;
   }
 
-  if(pid == queue->waitingForPid && isMessageAvailable(queue->first, pid, queue->messageSize-length)){
-    //*** Unblock process ***
-    process *p = getProcessByPid(queue->ownerPid);
-    unblockProcess(p);
+  queue->stats.bytes += length;
+  queue->stats.messages++;
+  if(queue->stats.bytes > queue->stats.highBytes){
+    queue->stats.highBytes = queue->stats.bytes;
+  }
+  if(queue->stats.messages > queue->stats.highMessages){
+    queue->stats.highMessages = queue->stats.messages;
   }
+
+  //los que esperan vuelven a mirar si les alcanza
+  wakeUp(queue);
 }
 
-void receiveMessage(messageQueueADT queue, int pid, char* dest, int length){
-  if(isMessageAvailable(queue->first, pid, length) == 0){
-    //*** Block process ***
-    queue->waitingForPid=pid;
-    queue->messageSize = length;
-    process *p = getCurrentProcess();
+//los bytes vienen todos de un mismo emisor, devuelve cual
+int receiveMessage(messageQueueADT queue, int pid, char* dest, int length){
+  pollEntry entry = {pid, length, 0, -1};
+  int sender;
 
-    blockProcess(p);
-    yieldProcess();
-    receiveMessage(queue, pid, dest, length);
-  }else{
-    searchMessage(queue, pid, length, dest);
+  while((sender = readySender(queue, pid, length)) < 0){
+    //el emisor que espera puede estar trabado por la cola llena
+    awaitSenders(queue, &entry, 1);
+    sleepOn(queue);
+  }
+  stopAwaiting(queue);
+  searchMessage(queue, sender, length, dest);
+  return sender;
+}
+
+//devuelve -1 sin esperar si todavia no llegaron length bytes de pid
+int tryReceiveMessage(messageQueueADT queue, int pid, char* dest, int length){
+  int sender = readySender(queue, pid, length);
+
+  if(sender < 0){
+    return -1;
+  }
+  searchMessage(queue, sender, length, dest);
+  return sender;
+}
+
+/* Marca las entradas que ya se pueden recibir y devuelve cuantas son.
+** Espera hasta que haya alguna o pasen timeout ticks; con timeout 0
+** no espera y con uno negativo espera sin limite. */
+int pollMessages(messageQueueADT queue, pollEntry* entries, int count, int timeout){
+  int deadline = ticks_elapsed() + timeout;
+  int i, ready;
+
+  while(1){
+    ready = 0;
+    for(i = 0; i < count; i++){
+      entries[i].sender = readySender(queue, entries[i].pid, entries[i].length > 0 ? entries[i].length : 1);
+      entries[i].ready = entries[i].sender >= 0;
+      ready += entries[i].ready;
+    }
+
+    if(ready > 0 || timeout == 0 || (timeout > 0 && ticks_elapsed() >= deadline)){
+      stopAwaiting(queue);
+      return ready;
+    }
+    awaitSenders(queue, entries, count);
+    sleepOnUntil(queue, timeout > 0 ? deadline : 0);
+  }
+}
+
+/* El emisor del que ya llegaron length bytes, con POLL_ANY el del
+** mensaje mas viejo que alcance. -1 si no hay ninguno. */
+static int readySender(messageQueueADT queue, int pid, int length){
+  struct messageNode * curr;
+
+  if(pid != POLL_ANY){
+    return isMessageAvailable(queue->first, pid, length) ? pid : -1;
+  }
+  for(curr = queue->first; curr != NULL; curr = curr->tail){
+    if(isMessageAvailable(curr, curr->message->pid, length)){
+      return curr->message->pid;
+    }
+  }
+  return -1;
+}
+
+static void releaseMessage(struct messageNode * node){
+  if(node->message->shared != NULL){
+    releaseShared(node->message->shared);
+  }
+  free(node);
+}
+
+//el ultimo que lo lee lo libera
+static void releaseShared(struct sharedPayload * shared){
+  if(--shared->refs == 0){
+    free(shared);
   }
 }
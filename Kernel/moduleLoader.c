@@ -1,29 +1,143 @@
 #include <moduleLoader.h>
+#include <lz4.h>
 
-static void loadModule(uint8_t **module, void *targetModuleAddress);
-static uint32_t readUint32(uint8_t **address);
+static void loadModule(moduleEntry *module);
+static void *getPayload(moduleEntry *module);
+static uint32_t checksum(const uint8_t *data, uint64_t size);
 
-void loadModules(void *payloadStart, void **targetModuleAddress)
+static moduleTable *table = NULL;
+static int corruptModules = 0;
+
+void *loadModules(void *payloadStart)
 {
 	int i;
-	uint8_t *currentModule = (uint8_t *)payloadStart;
-	uint32_t moduleCount = readUint32(&currentModule);
+	moduleEntry *entries;
+	uint64_t residentEnd;
+
+	table = (moduleTable *)payloadStart;
+	if (table->magic != MODULE_TABLE_MAGIC)
+	{
+		table = NULL;
+		return payloadStart;
+	}
+
+	entries = (moduleEntry *)(table + 1);
+	residentEnd = (uint64_t)&entries[table->count];
+
+	for (i = 0; i < table->count; i++)
+	{
+		if (entries[i].loadAddress != MODULE_IN_PLACE)
+			loadModule(&entries[i]);
+		else if ((uint64_t)getPayload(&entries[i]) + entries[i].packedSize > residentEnd)
+			residentEnd = (uint64_t)getPayload(&entries[i]) + entries[i].packedSize;
+	}
+
+	/* Payloads that were copied out lie past residentEnd and get reused */
+	return (void *)((residentEnd + PAGE_SIZE - 1) & ~(uint64_t)(PAGE_SIZE - 1));
+}
+
+static void loadModule(moduleEntry *module)
+{
+	if (readModule(module, (void *)module->loadAddress) < 0)
+		corruptModules++;
+}
+
+/* Bytes from the table to the end of the last payload, 0 without a
+** table. Only reads the image, so it works before .bss is cleared. */
+uint64_t getPackedSize(void *payloadStart)
+{
+	moduleTable *packed = (moduleTable *)payloadStart;
+	moduleEntry *entries = (moduleEntry *)(packed + 1);
+	uint64_t size, i;
+
+	if (packed->magic != MODULE_TABLE_MAGIC)
+		return 0;
 
-	for (i = 0; i < moduleCount; i++)
-		loadModule(&currentModule, targetModuleAddress[i]);
+	size = (uint64_t)&entries[packed->count] - (uint64_t)packed;
+	for (i = 0; i < packed->count; i++)
+		if (entries[i].offset + entries[i].packedSize > size)
+			size = entries[i].offset + entries[i].packedSize;
+	return size;
 }
 
-static void loadModule(uint8_t **module, void *targetModuleAddress)
+int64_t readModule(moduleEntry *module, void *destination)
 {
-	uint32_t moduleSize = readUint32(module);
-	memcpy(targetModuleAddress, *module, moduleSize);
-	*module += moduleSize;
+	if (module->flags & MODULE_LZ4)
+	{
+		if (lz4Decompress(getPayload(module), module->packedSize, destination, module->size) != module->size)
+			return -1;
+	}
+	else
+		memcpy(destination, getPayload(module), module->size);
 
+	if (checksum(destination, module->size) != module->checksum)
+		return -1;
+
+	return module->size;
 }
 
-static uint32_t readUint32(uint8_t **address)
+moduleEntry *getModule(const char *name)
 {
-	uint32_t result = *(uint32_t *)(*address);
-	*address += sizeof(uint32_t);
-	return result;
+	int i;
+	moduleEntry *entries;
+
+	if (table == NULL)
+		return NULL;
+
+	entries = (moduleEntry *)(table + 1);
+	for (i = 0; i < table->count; i++)
+	{
+		if (strcmpKernel(entries[i].name, name) == 0)
+		{
+			if (entries[i].loadAddress == MODULE_IN_PLACE && !(entries[i].flags & MODULE_LZ4) &&
+				checksum(getModuleContents(&entries[i]), entries[i].size) != entries[i].checksum)
+				return NULL;
+			return &entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+void *getModuleContents(moduleEntry *module)
+{
+	if (module->loadAddress != MODULE_IN_PLACE)
+		return (void *)module->loadAddress;
+	/* Compressed modules that stay in the image need readModule */
+	if (module->flags & MODULE_LZ4)
+		return NULL;
+	return getPayload(module);
+}
+
+static void *getPayload(moduleEntry *module)
+{
+	return (uint8_t *)table + module->offset;
+}
+
+int getCorruptModules()
+{
+	return corruptModules;
+}
+
+/* Adler-32, the same checksum ModulePacker writes. The modulo is deferred
+** for as many bytes as can be summed without overflowing 32 bits. */
+static uint32_t checksum(const uint8_t *data, uint64_t size)
+{
+	uint32_t a = 1, b = 0;
+	uint64_t block;
+
+	while (size > 0)
+	{
+		block = size < 5552 ? size : 5552;
+		size -= block;
+		while (block--)
+		{
+			a += *data++;
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+
+	return (b << 16) | a;
 }
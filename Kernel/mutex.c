@@ -4,17 +4,19 @@
 #include "processes.h"
 #include "scheduler.h"
 #include "videoDriver.h"
+#include "futex.h"
 
 static mutexADT *mutex;
 static int id = 0;
 static int numberOfMutexes = 0;
 
+/* value va primero: userland toma el mutex directamente sobre el.
+** 1 libre, 0 tomado, -1 tomado con procesos esperando */
 typedef struct mutex_t
 {
-	char* name;
 	int value;
+	char* name;
 	int id;
-	process* blockedProcesses[MAX_PROCESSES];
 } mutex_t;
 
 mutex_t *mutexInit(char *name)
@@ -32,10 +34,6 @@ mutex_t *mutexInit(char *name)
 	strcpyKernel(newMutex->name, name);
 	newMutex->value = 1;
 	newMutex->id = id;
-	for(int i = 0; i < MAX_PROCESSES; i++)
-	{
-		newMutex->blockedProcesses[i] = NULL;
-	}
 
 	id++;
 	numberOfMutexes++;
@@ -44,27 +42,35 @@ mutex_t *mutexInit(char *name)
 	return newMutex;
 }
 
+/* Mismo protocolo que el de userland, aca las interrupciones ya estan
+** apagadas y no hace falta ser atomico */
 int mutexLock(mutex_t *mut)
 {
-	while(mut->value==0)
+	if (mut->value == 1)
+	{
+		mut->value = 0;
+		return 0;
+	}
+
+	while (mut->value != 1)
 	{
-		process *p = getCurrentProcess();
-		blockProcess(p);
-		mut->blockedProcesses[getProcessPid(p)]= p;
-		yieldProcess();
+		mut->value = -1;
+		futexWait(&mut->value, -1);
 	}
-	mut->value = 0;
+	/* Puede haber otros esperando todavia */
+	mut->value = -1;
 	return 0;
 }
 
+/* Despierta a uno solo y sigue corriendo */
 int mutexUnlock(mutex_t *mut)
 {
-	for(int i = 0; i < MAX_PROCESSES; i++){
-		unblockProcess(mut->blockedProcesses[i]);
-	}
+	int contended = mut->value == -1;
+
 	mut->value = 1;
-	yieldProcess();
-	return mut->value;
+	if (contended)
+		futexWake(&mut->value, 1);
+	return 1;
 }
 
 int mutexListSize()
@@ -16,17 +16,17 @@ static uint64_t availableStackPage = 0;
 static uint64_t reserved = 0;
 static uint64_t reservedStack = 0;
 
-extern uint8_t endOfKernel;
-
 void restorePages();
 
-void initializePageAllocator()
+void initializePageAllocator(uint64_t firstFreeAddress)
 {
 	uint64_t ram = *((uint64_t *)SYSTEM_RAM_ADDRESS);
 	size = (ram * MB) / PAGE_SIZE;
-	reserved = (uint64_t)&endOfKernel / (PAGE_SIZE);
+	reserved = firstFreeAddress / (PAGE_SIZE);
 	availablePage = (reserved + 2);
 	reservedStack = (availablePage + PAGE_QTY) * PAGE_SIZE;
+	if (reservedStack < USERLAND_END)
+		reservedStack = USERLAND_END;
 	availableStackPage = reservedStack;
 }
 
@@ -52,6 +52,17 @@ uint64_t getStackPage()
 	}
 }
 
+/* Si getStackPage puede devolver una pagina sin quedarse colgado */
+int hasStackPage()
+{
+	return stackPagesLeft() > 0;
+}
+
+uint64_t stackPagesLeft()
+{
+	return stackPageIndex + (MAX_PROCESSES * MB + reservedStack - availableStackPage) / MB;
+}
+
 void releaseStackPage(uint64_t stackpage)
 {
 	stackPageIndex++;
@@ -61,6 +72,11 @@ void releaseStackPage(uint64_t stackpage)
 	}
 }
 
+int isStackPage(uint64_t address)
+{
+	return address >= reservedStack;
+}
+
 uint64_t peekAvailableStackPage()
 {
 	if (stackPageIndex != 0)
@@ -100,6 +116,12 @@ uint64_t getAvailablePage()
 		while (1);
 	}
 }
+/* Como hasStackPage, para getAvailablePage */
+int hasAvailablePage()
+{
+	return indexInStack != 0 || availablePage < (PAGE_QTY + reserved + 1);
+}
+
 uint64_t peekAvailablePage()
 {
 	if (indexInStack != 0)
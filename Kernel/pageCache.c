@@ -0,0 +1,379 @@
+#include <pageCache.h>
+#include <bmfs.h>
+#include <scheduler.h>
+#include <lib.h>
+
+#define NO_FILE -1
+
+typedef struct
+{
+	int slot;     /* Directory entry of the file, NO_FILE if the frame is free */
+	int mappings; /* Window pages pointing at the frame */
+	int dirty;
+	int busy;     /* Being read or written back, sleep on it */
+	uint64_t index; /* Page number inside the file */
+	uint64_t frame;
+	uint64_t lastUse;
+} cachedPage;
+
+typedef struct
+{
+	int used;
+	int slot;
+	uint64_t pid;
+	uint64_t offset;
+	uint64_t length;
+} mapping;
+
+static cachedPage *getPage(int slot, uint64_t index);
+static cachedPage *findPage(int slot, uint64_t index);
+static cachedPage *victimPage();
+static int writePage(cachedPage *page);
+static int writeBack(int slot, uint64_t first, uint64_t last);
+static mapping *findMapping(uint64_t address);
+static uint64_t mappingAddress(mapping *map);
+static void collectDirty(mapping *map);
+static void removeMapping(mapping *map);
+
+static cachedPage pages[PAGE_CACHE_FRAMES];
+static mapping mappings[MAX_MAPPINGS];
+static uint64_t useClock = 0;
+
+void initializePageCache()
+{
+	uint64_t frames = getStackPage();
+	int i;
+
+	for (i = 0; i < PAGE_CACHE_FRAMES; i++)
+	{
+		pages[i].slot = NO_FILE;
+		pages[i].frame = frames + i * PAGE_SIZE;
+	}
+}
+
+/* Maps length bytes of an open file starting at a page aligned offset.
+** Nothing is read until the pages are touched. Returns 0 on error. */
+uint64_t mmapFile(int fd, uint64_t offset, uint64_t length)
+{
+	int slot = bmfsGetSlot(fd), i;
+
+	if (slot < 0 || length == 0 || length > MAPPING_SIZE || offset % PAGE_SIZE != 0 ||
+		offset >= bmfsCapacity(slot) || length > bmfsCapacity(slot) - offset)
+		return 0;
+
+	for (i = 0; i < MAX_MAPPINGS; i++)
+	{
+		if (!mappings[i].used)
+		{
+			mappings[i].used = 1;
+			mappings[i].slot = slot;
+			mappings[i].pid = getProcessPid(getCurrentProcess());
+			mappings[i].offset = offset;
+			mappings[i].length = length;
+			return mappingAddress(&mappings[i]);
+		}
+	}
+
+	return 0;
+}
+
+/* Writes the pages of the range that were modified and syncs the disk */
+int msyncFile(uint64_t address, uint64_t length)
+{
+	mapping *map = findMapping(address);
+	uint64_t start, end;
+
+	if (map == NULL || length == 0)
+		return 0;
+
+	start = address - mappingAddress(map);
+	end = length > map->length - start ? map->length : start + length;
+
+	collectDirty(map);
+	return writeBack(map->slot, (map->offset + start) / PAGE_SIZE, (map->offset + end - 1) / PAGE_SIZE) &&
+		   bmfsSync();
+}
+
+int munmapFile(uint64_t address)
+{
+	mapping *map = findMapping(address);
+	int slot;
+
+	if (map == NULL || address != mappingAddress(map) || map->pid != getProcessPid(getCurrentProcess()))
+		return 0;
+
+	slot = map->slot;
+	removeMapping(map);
+	return pageCacheFlush(slot) && bmfsSync();
+}
+
+/* Drops the mappings of a removed process. It runs inside the scheduler,
+** so modified pages stay dirty in the cache until the next flush. */
+void unmapProcess(uint64_t pid)
+{
+	int i;
+
+	for (i = 0; i < MAX_MAPPINGS; i++)
+		if (mappings[i].used && mappings[i].pid == pid)
+			removeMapping(&mappings[i]);
+}
+
+/* Called from the page fault handler, may sleep on the disk.
+** Returns 0 if the address is not part of a mapping. */
+int pageFault(uint64_t address)
+{
+	uint64_t virtual = address & ~(uint64_t)(PAGE_SIZE - 1);
+	mapping *map = findMapping(address);
+	cachedPage *page;
+	int slot;
+
+	if (map == NULL)
+		return 0;
+	if (isMapped(virtual))
+		return 1;
+
+	slot = map->slot;
+	page = getPage(slot, (map->offset + virtual - mappingAddress(map)) / PAGE_SIZE);
+	if (page == NULL)
+		return 0;
+
+	/* The mapping could have changed while reading */
+	if (!map->used || map->slot != slot || isMapped(virtual) || !mapPage(virtual, page->frame))
+	{
+		page->mappings--;
+		return map->used && isMapped(virtual);
+	}
+
+	return 1;
+}
+
+/* System calls fault the pages of user buffers in beforehand, so the
+** file system is never entered from its own page faults */
+int prefaultRange(uint64_t address, uint64_t length)
+{
+	uint64_t virtual;
+
+	for (virtual = address & ~(uint64_t)(PAGE_SIZE - 1); virtual < address + length; virtual += PAGE_SIZE)
+		if (virtual >= MMAP_WINDOW && virtual < MMAP_WINDOW + MMAP_WINDOW_SIZE &&
+			!isMapped(virtual) && !pageFault(virtual))
+			return 0;
+
+	return 1;
+}
+
+/* Copies what write() stores into the cached pages of the file */
+void pageCacheUpdate(int slot, uint64_t offset, const void *buffer, uint64_t length)
+{
+	uint64_t start, from, to;
+	int i;
+
+	for (i = 0; i < PAGE_CACHE_FRAMES; i++)
+	{
+		if (pages[i].slot != slot)
+			continue;
+
+		start = pages[i].index * PAGE_SIZE;
+		from = start > offset ? start : offset;
+		to = start + PAGE_SIZE < offset + length ? start + PAGE_SIZE : offset + length;
+		if (from < to)
+			memcpy((void *)(pages[i].frame + from - start), (const uint8_t *)buffer + from - offset, to - from);
+	}
+}
+
+/* Writes the modified pages of a file into the block cache */
+int pageCacheFlush(int slot)
+{
+	int i;
+
+	for (i = 0; i < MAX_MAPPINGS; i++)
+		if (mappings[i].used && mappings[i].slot == slot)
+			collectDirty(&mappings[i]);
+
+	return writeBack(slot, 0, ~(uint64_t)0);
+}
+
+/* Forgets the pages of a deleted file, fails while it is mapped */
+int pageCacheDrop(int slot)
+{
+	int i;
+
+	for (i = 0; i < MAX_MAPPINGS; i++)
+		if (mappings[i].used && mappings[i].slot == slot)
+			return 0;
+
+	for (i = 0; i < PAGE_CACHE_FRAMES; i++)
+		if (pages[i].slot == slot && pages[i].busy)
+			return 0;
+
+	for (i = 0; i < PAGE_CACHE_FRAMES; i++)
+	{
+		if (pages[i].slot == slot)
+		{
+			pages[i].slot = NO_FILE;
+			pages[i].dirty = 0;
+		}
+	}
+
+	return 1;
+}
+
+/* Returns the page with a new reference, reading it if it isn't cached */
+static cachedPage *getPage(int slot, uint64_t index)
+{
+	cachedPage *page;
+	int64_t read;
+
+	while (1)
+	{
+		page = findPage(slot, index);
+		if (page != NULL && page->busy)
+		{
+			sleepOn(page);
+			continue;
+		}
+		if (page != NULL)
+			break;
+
+		if ((page = victimPage()) == NULL)
+			return NULL;
+
+		/* Writing sleeps, so everything is looked up again after it */
+		if (page->dirty)
+		{
+			if (!writePage(page))
+				return NULL;
+			continue;
+		}
+
+		page->slot = slot;
+		page->index = index;
+		page->busy = 1;
+
+		/* Past the end of the file the page reads as zeros */
+		memset((void *)page->frame, 0, PAGE_SIZE);
+		read = bmfsReadAt(slot, index * PAGE_SIZE, (void *)page->frame, PAGE_SIZE);
+
+		page->busy = 0;
+		wakeUp(page);
+		if (read < 0)
+		{
+			page->slot = NO_FILE;
+			return NULL;
+		}
+		break;
+	}
+
+	page->mappings++;
+	page->lastUse = ++useClock;
+	return page;
+}
+
+static cachedPage *findPage(int slot, uint64_t index)
+{
+	int i;
+
+	for (i = 0; i < PAGE_CACHE_FRAMES; i++)
+		if (pages[i].slot == slot && pages[i].index == index)
+			return &pages[i];
+
+	return NULL;
+}
+
+/* A free frame, or the least recently used one nobody has mapped */
+static cachedPage *victimPage()
+{
+	cachedPage *victim = NULL;
+	int i;
+
+	for (i = 0; i < PAGE_CACHE_FRAMES; i++)
+	{
+		if (pages[i].slot == NO_FILE)
+			return &pages[i];
+		if (pages[i].mappings == 0 && !pages[i].busy && (victim == NULL || pages[i].lastUse < victim->lastUse))
+			victim = &pages[i];
+	}
+
+	return victim;
+}
+
+/* Page writes don't change the file size, data past it is not kept */
+static int writePage(cachedPage *page)
+{
+	int ok;
+
+	page->busy = 1;
+	page->dirty = 0;
+	ok = bmfsWriteAt(page->slot, page->index * PAGE_SIZE, (void *)page->frame, PAGE_SIZE) >= 0;
+	if (!ok)
+		page->dirty = 1;
+	page->busy = 0;
+	wakeUp(page);
+
+	return ok;
+}
+
+static int writeBack(int slot, uint64_t first, uint64_t last)
+{
+	int i, ok = 1;
+
+	for (i = 0; i < PAGE_CACHE_FRAMES; i++)
+		if (pages[i].slot == slot && pages[i].dirty && !pages[i].busy &&
+			pages[i].index >= first && pages[i].index <= last && !writePage(&pages[i]))
+			ok = 0;
+
+	return ok;
+}
+
+static mapping *findMapping(uint64_t address)
+{
+	mapping *map;
+
+	if (address < MMAP_WINDOW || address >= MMAP_WINDOW + MMAP_WINDOW_SIZE)
+		return NULL;
+
+	map = &mappings[(address - MMAP_WINDOW) / MAPPING_SIZE];
+	if (!map->used || address - mappingAddress(map) >= map->length)
+		return NULL;
+
+	return map;
+}
+
+static uint64_t mappingAddress(mapping *map)
+{
+	return MMAP_WINDOW + (map - mappings) * MAPPING_SIZE;
+}
+
+/* Moves the dirty bits of the page tables to the cache */
+static void collectDirty(mapping *map)
+{
+	uint64_t base = mappingAddress(map), virtual;
+	cachedPage *page;
+
+	for (virtual = base; virtual < base + map->length; virtual += PAGE_SIZE)
+		if (clearDirty(virtual) && (page = findPage(map->slot, (map->offset + virtual - base) / PAGE_SIZE)) != NULL)
+			page->dirty = 1;
+}
+
+static void removeMapping(mapping *map)
+{
+	uint64_t base = mappingAddress(map), virtual;
+	cachedPage *page;
+	int dirty;
+
+	for (virtual = base; virtual < base + map->length; virtual += PAGE_SIZE)
+	{
+		if (!isMapped(virtual))
+			continue;
+
+		dirty = unmapPage(virtual);
+		page = findPage(map->slot, (map->offset + virtual - base) / PAGE_SIZE);
+		if (page != NULL)
+		{
+			page->dirty |= dirty;
+			page->mappings--;
+		}
+	}
+
+	releasePageTables(base, MAPPING_SIZE);
+	map->used = 0;
+}
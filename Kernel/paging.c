@@ -0,0 +1,154 @@
+#include <paging.h>
+#include <pageAllocator.h>
+#include <lib.h>
+
+#define PAGE_PRESENT 0x1
+#define PAGE_WRITABLE 0x2
+#define PAGE_DIRTY 0x40
+#define PAGE_LARGE 0x80
+#define ADDRESS_MASK 0x000FFFFFFFFFF000
+
+#define ENTRIES 512
+#define LARGE_PAGE 0x200000
+
+static uint64_t *newTable();
+static uint64_t *getEntry(uint64_t virtual);
+
+static uint64_t *pml4;
+static uint64_t *windowDirectory;
+
+/* Tables come from a stack page, the free ones are chained through
+** their first entry */
+static uint64_t *freeTables = NULL;
+
+/* Replaces the tables Pure64 left in low memory, which map every page
+** as 2MiB and leave no room for the window */
+void initializePaging()
+{
+	uint64_t pool = getStackPage(), *pdpt, *directory, i, j;
+
+	for (i = 0; i < MB / PAGE_SIZE; i++)
+	{
+		directory = (uint64_t *)(pool + i * PAGE_SIZE);
+		directory[0] = (uint64_t)freeTables;
+		freeTables = directory;
+	}
+
+	pml4 = newTable();
+	pdpt = newTable();
+	pml4[0] = (uint64_t)pdpt | PAGE_PRESENT | PAGE_WRITABLE;
+
+	for (i = 0; i < IDENTITY_GIBS; i++)
+	{
+		directory = newTable();
+		pdpt[i] = (uint64_t)directory | PAGE_PRESENT | PAGE_WRITABLE;
+		for (j = 0; j < ENTRIES; j++)
+			directory[j] = (i * ENTRIES + j) * LARGE_PAGE | PAGE_PRESENT | PAGE_WRITABLE | PAGE_LARGE;
+	}
+
+	pdpt = newTable();
+	windowDirectory = newTable();
+	pml4[(MMAP_WINDOW >> 39) & (ENTRIES - 1)] = (uint64_t)pdpt | PAGE_PRESENT | PAGE_WRITABLE;
+	pdpt[(MMAP_WINDOW >> 30) & (ENTRIES - 1)] = (uint64_t)windowDirectory | PAGE_PRESENT | PAGE_WRITABLE;
+
+	writeCR3((uint64_t)pml4);
+}
+
+/* Maps a 4KiB page of the window, creating its page table if needed */
+int mapPage(uint64_t virtual, uint64_t physical)
+{
+	uint64_t index = (virtual - MMAP_WINDOW) / LARGE_PAGE, *table;
+
+	if (virtual < MMAP_WINDOW || virtual >= MMAP_WINDOW + MMAP_WINDOW_SIZE)
+		return 0;
+
+	if (!(windowDirectory[index] & PAGE_PRESENT))
+	{
+		if ((table = newTable()) == NULL)
+			return 0;
+		windowDirectory[index] = (uint64_t)table | PAGE_PRESENT | PAGE_WRITABLE;
+	}
+
+	table = (uint64_t *)(windowDirectory[index] & ADDRESS_MASK);
+	table[(virtual / PAGE_SIZE) % ENTRIES] = (physical & ADDRESS_MASK) | PAGE_PRESENT | PAGE_WRITABLE;
+	invalidatePage(virtual);
+	return 1;
+}
+
+/* Returns whether the page was written while mapped */
+int unmapPage(uint64_t virtual)
+{
+	uint64_t *entry = getEntry(virtual), dirty;
+
+	if (entry == NULL || !(*entry & PAGE_PRESENT))
+		return 0;
+
+	dirty = *entry & PAGE_DIRTY;
+	*entry = 0;
+	invalidatePage(virtual);
+	return dirty != 0;
+}
+
+int isMapped(uint64_t virtual)
+{
+	uint64_t *entry = getEntry(virtual);
+
+	return entry != NULL && (*entry & PAGE_PRESENT);
+}
+
+/* Returns whether the page was written since the last call */
+int clearDirty(uint64_t virtual)
+{
+	uint64_t *entry = getEntry(virtual);
+
+	if (entry == NULL || !(*entry & PAGE_PRESENT) || !(*entry & PAGE_DIRTY))
+		return 0;
+
+	*entry &= ~(uint64_t)PAGE_DIRTY;
+	invalidatePage(virtual);
+	return 1;
+}
+
+/* Gives back the page tables of a 2MiB aligned range already unmapped */
+void releasePageTables(uint64_t virtual, uint64_t length)
+{
+	uint64_t index, *table;
+
+	for (index = (virtual - MMAP_WINDOW) / LARGE_PAGE; index < (virtual + length - MMAP_WINDOW) / LARGE_PAGE; index++)
+	{
+		if (!(windowDirectory[index] & PAGE_PRESENT))
+			continue;
+
+		table = (uint64_t *)(windowDirectory[index] & ADDRESS_MASK);
+		windowDirectory[index] = 0;
+		table[0] = (uint64_t)freeTables;
+		freeTables = table;
+	}
+
+	/* Also drops the cached directory entries */
+	writeCR3((uint64_t)pml4);
+}
+
+static uint64_t *newTable()
+{
+	uint64_t *table = freeTables;
+
+	if (table != NULL)
+	{
+		freeTables = (uint64_t *)table[0];
+		memset(table, 0, PAGE_SIZE);
+	}
+
+	return table;
+}
+
+static uint64_t *getEntry(uint64_t virtual)
+{
+	uint64_t index = (virtual - MMAP_WINDOW) / LARGE_PAGE;
+
+	if (virtual < MMAP_WINDOW || virtual >= MMAP_WINDOW + MMAP_WINDOW_SIZE ||
+		!(windowDirectory[index] & PAGE_PRESENT))
+		return NULL;
+
+	return (uint64_t *)(windowDirectory[index] & ADDRESS_MASK) + (virtual / PAGE_SIZE) % ENTRIES;
+}
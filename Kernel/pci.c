@@ -0,0 +1,52 @@
+#include <pci.h>
+#include <lib.h>
+
+/* Configuration mechanism #1, like os_pci_read_reg in Pure64 */
+#define PCI_CONFIG_ADDRESS 0xCF8
+#define PCI_CONFIG_DATA 0xCFC
+
+static uint32_t configAddress(uint8_t bus, uint8_t slot, uint8_t function, uint8_t offset)
+{
+	return 0x80000000 | ((uint32_t)bus << 16) | ((uint32_t)slot << 11) |
+		   ((uint32_t)function << 8) | (offset & 0xFC);
+}
+
+uint32_t pciRead(pciDevice *device, uint8_t offset)
+{
+	outl(PCI_CONFIG_ADDRESS, configAddress(device->bus, device->slot, device->function, offset));
+	return inl(PCI_CONFIG_DATA);
+}
+
+void pciWrite(pciDevice *device, uint8_t offset, uint32_t value)
+{
+	outl(PCI_CONFIG_ADDRESS, configAddress(device->bus, device->slot, device->function, offset));
+	outl(PCI_CONFIG_DATA, value);
+}
+
+/* Brute force scan, Pure64 leaves no device list behind for the kernel */
+int pciFindClass(uint8_t classCode, uint8_t subclass, pciDevice *device)
+{
+	uint32_t bus, slot, function, class;
+
+	for (bus = 0; bus < 256; bus++)
+		for (slot = 0; slot < 32; slot++)
+			for (function = 0; function < 8; function++)
+			{
+				outl(PCI_CONFIG_ADDRESS, configAddress(bus, slot, function, 0));
+				if ((inl(PCI_CONFIG_DATA) & 0xFFFF) == 0xFFFF)
+					continue;
+
+				outl(PCI_CONFIG_ADDRESS, configAddress(bus, slot, function, PCI_CLASS));
+				class = inl(PCI_CONFIG_DATA);
+				if ((class >> 24) == classCode && ((class >> 16) & 0xFF) == subclass)
+				{
+					device->bus = bus;
+					device->slot = slot;
+					device->function = function;
+					device->progIf = (class >> 8) & 0xFF;
+					return 1;
+				}
+			}
+
+	return 0;
+}
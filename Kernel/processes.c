@@ -6,10 +6,39 @@
 #include "scheduler.h"
 #include "videoDriver.h"
 #include "messageQueueADT.h"
+#include "programLoader.h"
+#include "bmfs.h"
+#include "pageCache.h"
+#include "ipc.h"
+#include "sharedMemory.h"
+#include "ring.h"
+#include "cpuGroup.h"
+#include "keyboardDriver.h"
 
 static void freeDataPages(process *p);
-
-static process *processesTable[MAX_PROCESSES] = {NULL};
+static void releaseProcess(process *p);
+static void removeThread(process *thread);
+static uint64_t getThreadStack();
+static void releaseThreadStack(uint64_t stack);
+static int firstFreeSlot();
+static int growTable();
+static void releaseSlot(uint64_t pid);
+static void releaseThreadSlot(int slot);
+static void reapProcess(process *p);
+static void adoptChildren(process *p);
+static void markDeleted(process *p);
+
+/* Indexed by the slot of the pid, grows up to MAX_PROCESSES */
+static process **processesTable = NULL;
+static uint64_t tableSize = 0;
+/* One bit per slot of the table, set while it is free */
+static uint64_t freeSlots[MAX_PROCESSES / 64] = {0};
+static uint32_t generations[MAX_PROCESSES] = {0};
+static process *threadsTable[MAX_THREADS] = {NULL};
+static uint32_t threadGenerations[MAX_THREADS] = {0};
+
+/* Free thread stacks, chained through their first word */
+static uint64_t freeThreadStacks = 0;
 static process *foreground = NULL;
 
 static uint64_t processesNumber = 0;
@@ -18,44 +47,118 @@ messageQueueADT getMessageQueue(int pid){
   return getProcessByPid(pid)->messageQueue;
 }
 
+/* Returns the new pid, -1 if the table is full */
 int insertProcess(process *p)
+{
+  int slot = firstFreeSlot();
+
+  if (slot < 0 && growTable())
+    slot = firstFreeSlot();
+  if (slot < 0)
+    return -1;
+
+  freeSlots[slot / 64] &= ~(1ULL << (slot % 64));
+  processesNumber++;
+  p->pid = (uint64_t)generations[slot] << PID_SLOT_BITS | slot;
+  processesTable[slot] = p;
+  return p->pid;
+}
+
+static int firstFreeSlot()
 {
   int i;
 
-  for (i = 0; i < MAX_PROCESSES; i++)
-  {
-    if (processesTable[i] == NULL)
-    {
-      processesNumber++;
-      p->pid = i;
-      processesTable[i] = p;
-      return i;
-    }
-  }
+  for (i = 0; i < MAX_PROCESSES / 64; i++)
+    if (freeSlots[i] != 0)
+      return i * 64 + __builtin_ctzll(freeSlots[i]);
 
   return -1;
 }
 
+static int growTable()
+{
+  uint64_t size = tableSize == 0 ? PROCESS_TABLE_STEP : tableSize * 2, i;
+  process **table;
+
+  if (tableSize == MAX_PROCESSES)
+    return 0;
+  if (size > MAX_PROCESSES)
+    size = MAX_PROCESSES;
+
+  table = (process **)malloc(size * sizeof(*table));
+  for (i = 0; i < size; i++)
+    table[i] = i < tableSize ? processesTable[i] : NULL;
+  for (i = tableSize; i < size; i++)
+    freeSlots[i / 64] |= 1ULL << (i % 64);
+
+  if (processesTable != NULL)
+    free((void *)processesTable);
+  processesTable = table;
+  tableSize = size;
+  return 1;
+}
+
+/* The next process in the slot gets another pid */
+static void releaseSlot(uint64_t pid)
+{
+  uint64_t slot = pid & PID_SLOT_MASK;
+
+  processesTable[slot] = NULL;
+  generations[slot] = (generations[slot] + 1) & ((1 << PID_GENERATION_BITS) - 1);
+  freeSlots[slot / 64] |= 1ULL << (slot % 64);
+}
+
 process *createProcess(uint64_t newProcessRIP, uint64_t argc, uint64_t argv, const char *name)
 {
-  process *newProcess = (process *)malloc(sizeof(*newProcess));
+  process *newProcess;
+
+  /* Sin pagina de stack getStackPage no vuelve */
+  if (!hasStackPage())
+    return NULL;
+
+  newProcess = (process *)malloc(sizeof(*newProcess));
+  if (insertProcess(newProcess) < 0)
+  {
+    free((void *)newProcess);
+    return NULL;
+  }
+
   strcpyKernel(newProcess->name, name);
   newProcess->stackPage = getStackPage();
   newProcess->status = READY;
-  newProcess->rsp = createNewProcessStack(newProcessRIP, newProcess->stackPage, argc, argv);
+  newProcess->rsp = createNewProcessStack(newProcessRIP, newProcess->stackPage + MB, argc, argv);
+  newProcess->program = NULL;
+  newProcess->waitChannel = NULL;
+  newProcess->sleepTicket = 0;
+  newProcess->wakeTick = 0;
+  newProcess->holdsLocks = 0;
+  newProcess->deletePending = 0;
+  newProcess->sharedMemory = 0;
+  newProcess->ring = NULL;
+  newProcess->schedNode = NULL;
+  newProcess->leader = NULL;
+  newProcess->tid = 0;
+  newProcess->threads = 0;
+  newProcess->exited = 0;
+  newProcess->finished = 0;
+  newProcess->result = 0;
+  newProcess->ipcState = IPC_IDLE;
   setNullAllProcessPages(newProcess);
-  insertProcess(newProcess);
   newProcess->messageQueue = newMessageQueue(newProcess->pid);
 
   if (newProcess->pid != 0)
   {
     newProcess->ppid = getProcessPid(getCurrentProcess());
+    cpuGroupInherit(newProcess, getCurrentProcess());
+    /* Los hijos de un programa corren código de su imagen */
+    setProcessProgram(newProcess, getCurrentProcess()->program);
   }
   else
   {
     /* Pone en foreground al primer proceso */
     foreground = newProcess;
     newProcess->ppid = 0;
+    cpuGroupInherit(newProcess, NULL);
   }
 
   return newProcess;
@@ -63,12 +166,47 @@ process *createProcess(uint64_t newProcessRIP, uint64_t argc, uint64_t argv, con
 
 process *getProcessByPid(uint64_t pid)
 {
-  if (pid < MAX_PROCESSES && processesTable[pid] != NULL && !isProcessDeleted(processesTable[pid]))
-  {
-    return processesTable[pid];
-  }
+  uint64_t slot = pid & PID_SLOT_MASK;
+  process *p;
+
+  if (slot >= tableSize || (p = processesTable[slot]) == NULL || p->pid != pid || isProcessDeleted(p) ||
+      p->status == ZOMBIE)
+    return NULL;
+
+  return p;
+}
+
+/* Processes and threads numbered together: a process is its pid and
+** a thread is THREAD_TASK | tid, both tagged with their generation */
+uint64_t getTaskId(process *p)
+{
+  return p->leader == NULL ? p->pid : THREAD_TASK | p->tid;
+}
+
+process *getTaskById(uint64_t id)
+{
+  process *p;
+
+  if (!(id & THREAD_TASK))
+    return getProcessByPid(id);
+  if ((id & PID_SLOT_MASK) >= MAX_THREADS)
+    return NULL;
 
-  return NULL;
+  p = threadsTable[id & PID_SLOT_MASK];
+  return p == NULL || (THREAD_TASK | p->tid) != id || isProcessDeleted(p) ? NULL : p;
+}
+
+/* To walk every process and thread, deleted ones included */
+uint64_t getTaskSlots()
+{
+  return tableSize + MAX_THREADS;
+}
+
+process *getTaskBySlot(uint64_t slot)
+{
+  if (slot < tableSize)
+    return processesTable[slot];
+  return slot < tableSize + MAX_THREADS ? threadsTable[slot - tableSize] : NULL;
 }
 
 void setNullAllProcessPages(process *process)
@@ -83,25 +221,275 @@ void setNullAllProcessPages(process *process)
   process->dataPageCount = 0;
 }
 
+/* Llamado por el scheduler cuando saca al proceso de la ronda */
 void removeProcess(process *p)
 {
+  int i;
 
-  if (p != NULL)
+  if (p == NULL)
+    return;
+
+  ipcAbort(p);
+
+  if (p->leader != NULL)
   {
-    processesNumber--;
-    freeDataPages(p);
-    if (foreground == p){
-      setProcessForeground(processesTable[p->ppid]->pid);
+    removeThread(p);
+    return;
+  }
+
+  if (foreground == p){
+    /* Si el padre ya no esta vuelve al shell */
+    setProcessForeground(p->ppid != 0 && getProcessByPid(p->ppid) != NULL ? p->ppid : 1);
+
+  }
+
+  /* Sus threads mueren con el; lo que comparten se libera con el ultimo */
+  p->status = DELETE;
+  p->exited = 1;
+  for (i = 0; i < MAX_THREADS; i++)
+    if (threadsTable[i] != NULL && threadsTable[i]->leader == p)
+      markDeleted(threadsTable[i]);
+
+  if (p->threads == 0)
+    releaseProcess(p);
+}
+
+/* Libera todo menos el pid y el exit status, que quedan hasta que el
+** padre los lea con waitProcess. Los hijos de init no esperan. */
+static void releaseProcess(process *p)
+{
+  process *parent;
+  int i;
+
+  for (i = 0; i < MAX_THREADS; i++)
+  {
+    if (threadsTable[i] != NULL && threadsTable[i]->leader == p)
+    {
+      free((void *)threadsTable[i]);
+      releaseThreadSlot(i);
+    }
+  }
+
+  freeDataPages(p);
+  shmReleaseProcess(p);
+  ringRelease(p);
+  cpuGroupLeave(p);
+  setProcessProgram(p, NULL);
+  bmfsCloseAll(p->pid);
+  unmapProcess(p->pid);
+  releaseStackPage(p->stackPage);
+  freeMessageQueue(p->messageQueue);
+  adoptChildren(p);
+
+  parent = getProcessByPid(p->ppid);
+  if (p->ppid != 0 && parent != NULL)
+  {
+    p->status = ZOMBIE;
+    p->waitChannel = NULL;
+    wakeUp(&parent->pid);
+  }
+  else
+    reapProcess(p);
+}
+
+static void reapProcess(process *p)
+{
+  processesNumber--;
+  releaseSlot(p->pid);
+  free((void *)p);
+}
+
+/* Los hijos pasan a init, que reapea a los que ya terminaron */
+static void adoptChildren(process *p)
+{
+  process *child;
+  uint64_t i;
+
+  for (i = 0; i < tableSize; i++)
+  {
+    child = processesTable[i];
+    if (child == NULL || child == p || child->ppid != p->pid)
+      continue;
+
+    child->ppid = 0;
+    if (child->status == ZOMBIE)
+      reapProcess(child);
+  }
+}
+
+/* Termina todo el proceso con status, aunque lo llame uno de sus threads */
+void exitProcess(int status)
+{
+  process *p = getCurrentProcess();
+  process *leader = p->leader != NULL ? p->leader : p;
 
+  leader->result = status;
+  if (leader != p)
+    markDeleted(leader);
+  killProcess();
+}
+
+/* Espera a que termine el hijo pid, o cualquiera con WAIT_ANY, y lo
+** reapea. Devuelve su pid, 0 con WNOHANG si todavia no termino ninguno
+** y -1 si no hay hijos que esperar. Los padres duermen en &pid. */
+int64_t waitProcess(int64_t pid, int *status, int flags)
+{
+  process *parent = getCurrentProcess(), *child;
+  uint64_t i;
+  int children;
+
+  if (parent->leader != NULL)
+    parent = parent->leader;
+
+  while (1)
+  {
+    children = 0;
+    for (i = 0; i < tableSize; i++)
+    {
+      child = processesTable[i];
+      if (child == NULL || child == parent || child->ppid != parent->pid ||
+          (pid != WAIT_ANY && child->pid != (uint64_t)pid))
+        continue;
+
+      if (child->status == ZOMBIE)
+      {
+        pid = child->pid;
+        if (status != NULL)
+          *status = (int)child->result;
+        reapProcess(child);
+        return pid;
+      }
+      children++;
     }
-    processesTable[p->pid] = NULL;
-    free((void *)p->stackPage);
-    free((void *)p);
-    free((void *)p->messageQueue);
 
+    if (children == 0)
+      return -1;
+    if (flags & WNOHANG)
+      return 0;
+    sleepOn(&parent->pid);
   }
 }
 
+/* The thread runs function(argument) through rip, a userland trampoline
+** that exits the thread when it returns. Returns NULL if none is free. */
+process *createThread(uint64_t rip, uint64_t function, uint64_t argument)
+{
+  process *leader = getCurrentProcess(), *thread;
+  int i;
+
+  if (leader->leader != NULL)
+    leader = leader->leader;
+
+  for (i = 0; i < MAX_THREADS && threadsTable[i] != NULL; i++)
+    ;
+  if (i == MAX_THREADS || (freeThreadStacks == 0 && !hasStackPage()))
+    return NULL;
+
+  thread = (process *)malloc(sizeof(*thread));
+  *thread = *leader;
+  thread->status = READY;
+  thread->stackPage = getThreadStack();
+  thread->rsp = createNewProcessStack(rip, thread->stackPage + THREAD_STACK_SIZE, function, argument);
+  thread->waitChannel = NULL;
+  thread->wakeTick = 0;
+  thread->holdsLocks = 0;
+  thread->deletePending = 0;
+  thread->sharedMemory = 0;
+  thread->ring = NULL;
+  thread->schedNode = NULL;
+  setNullAllProcessPages(thread);
+  thread->leader = leader;
+  thread->tid = (uint64_t)threadGenerations[i] << PID_SLOT_BITS | i;
+  thread->threads = 0;
+  thread->finished = 0;
+  thread->result = 0;
+  thread->ipcState = IPC_IDLE;
+
+  threadsTable[i] = thread;
+  leader->threads++;
+  return thread;
+}
+
+/* Waits for a thread of the same process and frees it */
+int joinThread(uint64_t tid, uint64_t *result)
+{
+  process *current = getCurrentProcess(), *thread;
+  uint64_t slot = tid & PID_SLOT_MASK;
+
+  if (slot >= MAX_THREADS || (thread = threadsTable[slot]) == NULL || thread->tid != tid ||
+      thread == current || thread->pid != current->pid)
+    return 0;
+
+  while (!thread->finished)
+  {
+    sleepOn(thread);
+    /* Someone else joined it first */
+    if (threadsTable[slot] != thread)
+      return 0;
+  }
+
+  if (result != NULL)
+    *result = thread->result;
+  releaseThreadSlot(slot);
+  free((void *)thread);
+  return 1;
+}
+
+/* Like releaseSlot, the next thread in the slot gets another tid */
+static void releaseThreadSlot(int slot)
+{
+  threadsTable[slot] = NULL;
+  threadGenerations[slot] = (threadGenerations[slot] + 1) & ((1 << PID_GENERATION_BITS) - 1);
+}
+
+/* For the process itself it is the same as exiting */
+void exitThread(uint64_t result)
+{
+  getCurrentProcess()->result = result;
+  killProcess();
+}
+
+int isThread(process *p)
+{
+  return p != NULL && p->leader != NULL;
+}
+
+static void removeThread(process *thread)
+{
+  process *leader = thread->leader;
+
+  releaseThreadStack(thread->stackPage);
+  thread->status = DELETE;
+  thread->finished = 1;
+  wakeUp(thread);
+  leader->threads--;
+
+  if (leader->exited && leader->threads == 0)
+    releaseProcess(leader);
+}
+
+static uint64_t getThreadStack()
+{
+  uint64_t stack, page;
+
+  if (freeThreadStacks == 0)
+  {
+    page = getStackPage();
+    for (stack = page; stack < page + MB; stack += THREAD_STACK_SIZE)
+      releaseThreadStack(stack);
+  }
+
+  stack = freeThreadStacks;
+  freeThreadStacks = *(uint64_t *)stack;
+  return stack;
+}
+
+static void releaseThreadStack(uint64_t stack)
+{
+  *(uint64_t *)stack = freeThreadStacks;
+  freeThreadStacks = stack;
+}
+
 /* Libera las páginas de datos usadas por el proceso. */
 static void freeDataPages(process *p)
 {
@@ -121,6 +509,9 @@ void addDataPage(process *p, void *page)
 {
   int i = 0;
 
+  if (p->leader != NULL)
+    p = p->leader;
+
   while (i < MAX_DATA_PAGES && p->dataPage[i] != NULL)
     i++;
 
@@ -131,10 +522,60 @@ void addDataPage(process *p, void *page)
   }
 }
 
+/* Despierta a todos los procesos dormidos en channel */
+void wakeUp(void *channel)
+{
+  wakeUpSome(channel, MAX_PROCESSES + MAX_THREADS);
+}
+
+/* Despierta a los count que duermen en channel hace mas tiempo.
+** Devuelve cuantos desperto. */
+int wakeUpSome(void *channel, int count)
+{
+  process *oldest;
+  int i, woken;
+
+  for (woken = 0; woken < count; woken++)
+  {
+    oldest = NULL;
+    for (i = 0; i < getTaskSlots(); i++)
+    {
+      process *p = getTaskBySlot(i);
+      /* Uno marcado DELETE puede haber quedado con su waitChannel */
+      if (p != NULL && p->status == BLOCKED && p->waitChannel == channel &&
+          (oldest == NULL || p->sleepTicket < oldest->sleepTicket))
+        oldest = p;
+    }
+
+    if (oldest == NULL)
+      break;
+    oldest->waitChannel = NULL;
+    unblockProcess(oldest);
+  }
+
+  return woken;
+}
+
+/* Llamado por el timer, despierta a los que se les vencio la espera */
+void wakeUpExpired(uint64_t tick)
+{
+  int i;
+
+  for (i = 0; i < getTaskSlots(); i++)
+  {
+    process *p = getTaskBySlot(i);
+    if (p != NULL && p->status == BLOCKED && p->waitChannel != NULL && p->wakeTick != 0 && p->wakeTick <= tick)
+    {
+      p->waitChannel = NULL;
+      unblockProcess(p);
+    }
+  }
+}
+
 void exitShell()
 {
   process *shell = getProcessByPid(1);
-  shell->status = DELETE;
+  markDeleted(shell);
 }
 
 int deleteThisProcess(int pid)
@@ -149,11 +590,38 @@ int deleteThisProcess(int pid)
 int deleteProcess(process *p)
 {
   if (p != NULL && p->pid != 1 && p->pid != 0)
-    p->status = DELETE;
+  {
+    markDeleted(p);
+    p->result = (uint64_t)KILLED_STATUS;
+  }
 
   return p != NULL;
 }
 
+/* Un proceso que duerme con un lock del kernel, como el del file
+** system, no se borra: lo soltaria nunca. Muere al liberarlo. */
+static void markDeleted(process *p)
+{
+  if (p->holdsLocks > 0)
+    p->deletePending = 1;
+  else
+    p->status = DELETE;
+}
+
+void deferDeletion(process *p)
+{
+  p->holdsLocks++;
+}
+
+void allowDeletion(process *p)
+{
+  if (--p->holdsLocks == 0 && p->deletePending)
+  {
+    p->deletePending = 0;
+    p->status = DELETE;
+  }
+}
+
 int isProcessDeleted(process *p)
 {
   if (p != NULL)
@@ -198,8 +666,11 @@ void blockProcess(process *p)
 
 void unblockProcess(process *p)
 {
-  if (p != NULL && p->status != DELETE)
+  if (p != NULL && p->status == BLOCKED)
+  {
     p->status = READY;
+    wakeUpPreempt(p);
+  }
 }
 
 int isProcessBlocked(process *p)
@@ -215,7 +686,8 @@ void setProcessForeground(int pid)
   if (p != NULL)
   {
     foreground = p;
-
+    /* El nuevo puede estar esperando una tecla que ya llego */
+    wakeUpKeyReaders();
   }
 }
 
@@ -280,8 +752,11 @@ uint64_t createNewProcessStack(uint64_t rip, uint64_t stackPage, uint64_t argc,
 void printPIDS()
 {
   int i;
-  for (i = 0; i < processesNumber; i++)
+  for (i = 0; i < tableSize; i++)
   {
+    if (processesTable[i] == NULL)
+      continue;
+
     printString("PID: ", 0, 155, 255);
     printDec(processesTable[i]->pid);
     printString("\n", 0, 155, 255);
@@ -312,6 +787,10 @@ void printPIDS()
     {
       printString("Awaiting Deletion", 0, 155, 255);
     }
+    else if (printStatus == ZOMBIE)
+    {
+      printString("Zombie", 0, 155, 255);
+    }
     else
     {
       printString("Error", 0, 155, 255);
@@ -0,0 +1,79 @@
+#include "programLoader.h"
+#include "moduleLoader.h"
+#include "pageAllocator.h"
+#include "scheduler.h"
+#include "lib.h"
+
+static int relocate(program *image, programHeader *header);
+
+/* Loads the program module on every spawn into a fresh 1MB region, so
+** the shell image doesn't grow with programs and nothing but the shell
+** is copied at boot. */
+int spawnProgram(const char *name, uint64_t argc, uint64_t argv)
+{
+  moduleEntry *module = getModule(name);
+  program *image;
+  programHeader *header;
+  process *p;
+
+  /* Una pagina para la imagen y otra para el stack del proceso */
+  if (module == NULL || module->loadAddress != MODULE_IN_PLACE || module->size > MB || stackPagesLeft() < 2)
+    return -1;
+
+  image = (program *)malloc(sizeof(*image));
+  image->base = getStackPage();
+  image->references = 0;
+  header = (programHeader *)image->base;
+
+  if (readModule(module, (void *)image->base) < 0 || header->magic != PROGRAM_MAGIC ||
+      header->imageSize + header->bssSize > MB ||
+      !relocate(image, header))
+  {
+    releaseProgram(image);
+    return -1;
+  }
+
+  memset((void *)(image->base + header->imageSize), 0, header->bssSize);
+
+  p = createProcess(image->base + header->entry, argc, argv, name);
+  if (p == NULL)
+  {
+    releaseProgram(image);
+    return -1;
+  }
+  setProcessProgram(p, image);
+  runProcess(p);
+  return getProcessPid(p);
+}
+
+static int relocate(program *image, programHeader *header)
+{
+  relocation *r = (relocation *)(image->base + header->relocations);
+  relocation *end = (relocation *)(image->base + header->relocationsEnd);
+
+  for (; r < end; r++)
+  {
+    if ((uint32_t)r->info != R_X86_64_RELATIVE || r->offset + sizeof(uint64_t) > header->imageSize)
+      return 0;
+    *(uint64_t *)(image->base + r->offset) = image->base + r->addend;
+  }
+
+  return 1;
+}
+
+void setProcessProgram(process *p, program *image)
+{
+  if (image != NULL)
+    image->references++;
+  releaseProgram(p->program);
+  p->program = image;
+}
+
+void releaseProgram(program *image)
+{
+  if (image != NULL && --image->references <= 0)
+  {
+    releaseStackPage(image->base);
+    free((void *)image);
+  }
+}
@@ -0,0 +1,117 @@
+#include <ring.h>
+#include <scheduler.h>
+#include <interrupts.h>
+#include <systemCallDispatcher.h>
+#include <lib.h>
+
+static void ringWorker(ioRing *ring);
+static int isRingOperation(uint64_t operation);
+
+/* Creates the rings of the current process and the kernel threads that
+** run its submissions. Blocking operations only block their worker, so
+** up to RING_WORKERS of them can be waiting at the same time. */
+ioRing *ringSetup()
+{
+	process *p = getCurrentProcess();
+	process *worker;
+	int i;
+
+	if (p->leader != NULL)
+		p = p->leader;
+	if (p->ring != NULL)
+		return p->ring;
+
+	p->ring = (ioRing *)malloc(sizeof(ioRing));
+	memset(p->ring, 0, sizeof(ioRing));
+
+	for (i = 0; i < RING_WORKERS; i++)
+	{
+		if ((worker = createThread((uint64_t)ringWorker, (uint64_t)p->ring, 0)) == NULL)
+			break;
+		runProcess(worker);
+	}
+
+	return p->ring;
+}
+
+/* Hands the new submissions to the workers and waits until there are
+** at least minComplete completions. Returns how many there are. */
+int ringEnter(uint64_t minComplete)
+{
+	process *p = getCurrentProcess();
+	ioRing *ring;
+
+	if (p->leader != NULL)
+		p = p->leader;
+	if ((ring = p->ring) == NULL)
+		return -1;
+	if (minComplete > RING_ENTRIES)
+		minComplete = RING_ENTRIES;
+
+	wakeUpSome((void *)&ring->sqTail, ring->sqTail - ring->sqHead);
+	/* Userland may have made room in cq since the last call */
+	wakeUp((void *)&ring->cqHead);
+
+	while (ring->cqTail - ring->cqHead < minComplete)
+		sleepOn((void *)&ring->cqTail);
+
+	return ring->cqTail - ring->cqHead;
+}
+
+/* Its workers are gone by the time the process is released */
+void ringRelease(process *p)
+{
+	if (p->ring != NULL)
+		free(p->ring);
+	p->ring = NULL;
+}
+
+/* Runs submissions as if they were system calls made by this process,
+** with interrupts off like any other system call */
+static void ringWorker(ioRing *ring)
+{
+	ringSubmission entry;
+	uint64_t result;
+
+	_disableInterrupts();
+
+	while (1)
+	{
+		while (ring->sqHead == ring->sqTail)
+			sleepOn((void *)&ring->sqTail);
+		entry = ring->sq[ring->sqHead % RING_ENTRIES];
+		ring->sqHead++;
+
+		if (isRingOperation(entry.operation))
+			result = systemCallDispatcher(entry.operation, entry.argument[0], entry.argument[1],
+										  entry.argument[2], entry.argument[3], entry.argument[4]);
+		else
+			result = -1;
+
+		while (ring->cqTail - ring->cqHead == RING_ENTRIES)
+			sleepOn((void *)&ring->cqHead);
+		ring->cq[ring->cqTail % RING_ENTRIES].userData = entry.userData;
+		ring->cq[ring->cqTail % RING_ENTRIES].result = result;
+		ring->cqTail++;
+		wakeUp((void *)&ring->cqTail);
+	}
+}
+
+/* Not from a worker: what ends the task or the process would end the
+** worker without posting a completion, waitpid would wait as the worker,
+** and the ring calls themselves */
+static int isRingOperation(uint64_t operation)
+{
+	switch (operation)
+	{
+	case SYS_KILL:
+	case SYS_THREAD_EXIT:
+	case SYS_EXIT:
+	case SYS_WAITPID:
+	case SYS_RING_SETUP:
+	case SYS_RING_ENTER:
+		return 0;
+	default:
+		return 1;
+	}
+}
@@ -0,0 +1,102 @@
+#include <stdint.h>
+#include "rwlock.h"
+#include "lib.h"
+#include "processes.h"
+#include "scheduler.h"
+
+/* Los lectores duermen sobre readers y los escritores sobre writer.
+** Mientras haya un escritor esperando no entran lectores nuevos, asi
+** una tabla muy leida no deja esperando para siempre al escritor. */
+typedef struct rwlock_t
+{
+	int readers;
+	int writer;
+	int waitingWriters;
+	char *name;
+} rwlock_t;
+
+static rwlock_t *locks[MAX_RWLOCKS];
+
+rwlock_t *rwlockInit(char *name)
+{
+	int i, empty = -1;
+
+	for (i = 0; i < MAX_RWLOCKS; i++)
+	{
+		if (locks[i] == NULL)
+		{
+			if (empty < 0)
+				empty = i;
+		}
+		else if (strcmpKernel(name, locks[i]->name) == 0)
+			return locks[i];
+	}
+	if (empty < 0)
+		return NULL;
+
+	rwlock_t *lock = (rwlock_t *)malloc(sizeof(rwlock_t));
+	lock->name = (char *)malloc(strlenKernel(name) + 1);
+	strcpyKernel(lock->name, name);
+	lock->readers = 0;
+	lock->writer = 0;
+	lock->waitingWriters = 0;
+	locks[empty] = lock;
+	return lock;
+}
+
+int readLock(rwlock_t *lock)
+{
+	while (lock->writer || lock->waitingWriters > 0)
+		sleepOn(&lock->readers);
+	lock->readers++;
+	return 0;
+}
+
+int readUnlock(rwlock_t *lock)
+{
+	if (lock->readers == 0)
+		return 1;
+	if (--lock->readers == 0 && lock->waitingWriters > 0)
+		wakeUpSome(&lock->writer, 1);
+	return 0;
+}
+
+int writeLock(rwlock_t *lock)
+{
+	lock->waitingWriters++;
+	while (lock->writer || lock->readers > 0)
+		sleepOn(&lock->writer);
+	lock->waitingWriters--;
+	lock->writer = 1;
+	return 0;
+}
+
+/* Primero los escritores, si no queda ninguno entran todos los lectores */
+int writeUnlock(rwlock_t *lock)
+{
+	if (!lock->writer)
+		return 1;
+	lock->writer = 0;
+	if (lock->waitingWriters > 0)
+		wakeUpSome(&lock->writer, 1);
+	else
+		wakeUp(&lock->readers);
+	return 0;
+}
+
+int rwlockClose(rwlock_t *lock)
+{
+	int i;
+
+	for (i = 0; i < MAX_RWLOCKS; i++)
+	{
+		if (locks[i] == lock)
+		{
+			locks[i] = NULL;
+			free(lock->name);
+			free(lock);
+			return 0;
+		}
+	}
+	return 1;
+}
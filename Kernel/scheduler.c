@@ -5,119 +5,574 @@
 #include "processes.h"
 #include "defs.h"
 #include "interrupts.h"
+#include "time.h"
+#include "cpuGroup.h"
+
+static nodeList *pickNext();
+static void handOff();
+static void runNext(nodeList *target, int quantum);
+static uint64_t fairMinVruntime(nodeList *except);
+static int isRunnable(nodeList *node);
+static void releaseNode(nodeList *node);
+
+/* Ni bloqueado ni sin cuota de cpu en este periodo */
+static int isRunnable(nodeList *node)
+{
+	return !isProcessBlocked(node->p) && !cpuGroupThrottled(node->p);
+}
+
+static void fairEnqueue(nodeList *node);
+static void fairDequeue(nodeList *node);
+static nodeList *fairPickNext();
+static void fairTick(nodeList *running);
+static void fairYield(nodeList *node);
 
-static void addProcess(process *p);
-static void setNextCurrent();
+static void realTimeEnqueue(nodeList *node);
+static void realTimeDequeue(nodeList *node);
+static nodeList *realTimePickNext();
+static void realTimeTick(nodeList *running);
+static void realTimeYield(nodeList *node);
+static int isBetter(nodeList *node, nodeList *best);
+
+/* Ronda de tiempo compartido */
+static schedClass fairClass = {fairEnqueue, fairDequeue, fairPickNext, fairTick, fairYield};
+/* FIFO por prioridad y EDF para tareas periodicas */
+static schedClass realTimeClass = {realTimeEnqueue, realTimeDequeue, realTimePickNext, realTimeTick, realTimeYield};
+
+/* De mayor a menor prioridad */
+static schedClass *classes[] = {&realTimeClass, &fairClass};
+#define CLASSES (sizeof(classes) / sizeof(classes[0]))
 
 /* Procesos actualmente bloqueados */
 static blockedProcess *firstBlockedProcess;
 
 /* Proceso actualmente corriendo */
 static nodeList *current = NULL;
-static nodeList *prev = NULL;
+
+/* El ultimo de la ronda que corrio, sigue si le queda quantum */
+static nodeList *fairCursor = NULL;
+
+/* Procesos de tiempo real, en cualquier orden */
+static nodeList *realTimeList = NULL;
+static uint64_t realTimeOrder = 0;
+static uint64_t realTimeTicks = 0;
+static uint64_t windowStart = 0;
+
+static uint64_t sleepTickets = 0;
+static uint64_t lastTick = 0;
+static int yielding = 0;
+
+/* Proceso al que el actual le cede la cpu, ver switchToProcess */
+static process *handoff = NULL;
+static int donatedQuantum;
+
+/* Despertado que tiene que correr apenas termine la interrupcion o
+** la syscall actual, ver wakeUpPreempt */
+static int needResched = 0;
+static nodeList *preemptor = NULL;
+
+/* Nodo del actual que ya salio de su clase. Se libera cuando corre otro:
+** removeProcess puede despertar a alguien y wakeUpPreempt lee el actual */
+static nodeList *retired = NULL;
 
 process *getCurrentProcess()
 {
 	return current->p;
 }
 
+/* Llamado en cada interrupcion y en cada yield. Los ticks se cuentan
+** solo cuando avanzo el timer, no con el teclado o el disco. */
 uint64_t nextProcess(uint64_t current_rsp)
 {
+	uint64_t now;
+	int i;
+
 	if (current == NULL)
 	{
 		return current_rsp;
 	}
 
-	decreaseQuantum();
+	if (retired != NULL && retired != current)
+	{
+		free((void *)retired);
+		retired = NULL;
+	}
 
-	if (current->quantum > 0)
-		return current_rsp;
+	setProcessRsp(current->p, current_rsp);
 
-	current->quantum = QUANTUM;
+	if (yielding)
+	{
+		yielding = 0;
+		current->class->yield(current);
+	}
+	else if ((now = ticks_elapsed()) != lastTick)
+	{
+		lastTick = now;
+		cpuGroupTick(current->p);
+		for (i = 0; i < CLASSES; i++)
+			classes[i]->tick(classes[i] == current->class ? current : NULL);
+	}
 
-	setProcessRsp(current->p, current_rsp);
+	if (handoff != NULL)
+		handOff();
 
-	prev = current;
-	current = current->next;
+	needResched = 0;
+	if (preemptor != NULL)
+	{
+		runNext(preemptor, QUANTUM);
+		preemptor = NULL;
+	}
 
-	setNextCurrent();
+	current = pickNext();
 
 	return getProcessRsp(current->p);
 }
 
 uint64_t runProcess(process *new_process)
 {
+	nodeList *new_node = (nodeList *)malloc(sizeof(*new_node));
 	int pid;
 
-	addProcess(new_process);
+	new_node->p = new_process;
+	new_node->quantum = QUANTUM;
+	new_node->vruntime = 0;
+	new_node->class = &fairClass;
+	new_node->attr.policy = SCHED_FAIR;
+	new_node->attr.priority = 0;
+	new_node->attr.runtime = 0;
+	new_node->attr.period = 0;
+	new_process->schedNode = new_node;
+	fairEnqueue(new_node);
 
 	pid = getProcessPid(new_process);
 
-	if (pid == 0)
+	/* El primer proceso arranca el scheduler */
+	if (pid == 0 && !isThread(new_process))
+	{
+		current = pickNext();
 		_changeProcess(getProcessRsp(current->p));
+	}
 
 	return pid;
 }
 
-static void addProcess(process *p)
+void killProcess()
 {
-	nodeList *new_node = (nodeList *)malloc(sizeof(*new_node));
+	nodeList *n = current;
+	removeProcess(n->p);
+	n->class->dequeue(n);
+	free((void *)n);
+	current = pickNext();
+	_changeProcess(getProcessRsp(current->p));
+}
 
-	new_node->p = p;
-	new_node->quantum = QUANTUM;
+void yieldProcess()
+{
+	yielding = 1;
+	_yieldProcess();
+}
 
-	if (current == NULL)
+/* Le da a p lo que queda del quantum del proceso actual y lo pone a
+** correr ya, sin esperar a que la ronda llegue a el. p se mueve a
+** continuacion del actual y corre en su turno en vez del propio, asi
+** nadie se saltea y dos procesos cediendose la cpu no ganan mas que
+** sus dos turnos. Solo entre procesos de la ronda. */
+void switchToProcess(process *p)
+{
+	handoff = p;
+	donatedQuantum = current->quantum > 0 && current->quantum <= QUANTUM ? current->quantum : QUANTUM;
+	yieldProcess();
+}
+
+/* Devuelve 0 si p no existe o no esta listo, sin ceder la cpu */
+int yieldTo(process *p)
+{
+	if (p == NULL || p == current->p || isProcessBlocked(p) || isProcessDeleted(p) || cpuGroupThrottled(p))
+		return 0;
+
+	switchToProcess(p);
+	return 1;
+}
+
+/* Bloquea al proceso actual hasta un wakeUp(channel). Quien llama
+** vuelve a chequear su condicion, como en mutexLock. */
+void sleepOn(void *channel)
+{
+	process *p = current->p;
+
+	p->waitChannel = channel;
+	p->sleepTicket = ++sleepTickets;
+	blockProcess(p);
+	yieldProcess();
+}
+
+/* Como sleepOn, pero el timer lo despierta en el tick dado si nadie lo
+** hizo antes. Con tick 0 no hay limite. */
+void sleepOnUntil(void *channel, uint64_t tick)
+{
+	current->p->wakeTick = tick;
+	sleepOn(channel);
+	current->p->wakeTick = 0;
+}
+
+/* Llamado al despertar a p. Si es de tiempo real basta con volver a
+** elegir. Si es de la ronda corre antes que el actual cuando uso menos
+** cpu que el: a quien durmio se le perdona hasta SLEEPER_CREDIT ticks
+** por debajo del minimo, como un proceso interactivo. */
+void wakeUpPreempt(process *p)
+{
+	nodeList *node = p->schedNode;
+	uint64_t min;
+
+	if (current == NULL || node == NULL || p == current->p)
+		return;
+
+	if (node->class == &realTimeClass)
 	{
-		current = new_node;
-		current->next = current;
-		prev = current;
+		needResched = 1;
+		return;
 	}
-	else
+
+	min = fairMinVruntime(node);
+	if (min > SLEEPER_CREDIT && node->vruntime < min - SLEEPER_CREDIT)
+		node->vruntime = min - SLEEPER_CREDIT;
+
+	if (current->class == &fairClass && !cpuGroupThrottled(p) &&
+		node->vruntime + WAKEUP_GRANULARITY <= current->vruntime)
 	{
-		new_node->next = current->next;
-		current->next = new_node;
+		preemptor = node;
+		needResched = 1;
 	}
 }
 
-void killProcess()
+/* Desde una syscall: cede la cpu sin perder el turno si se desperto
+** alguien que tiene que correr antes */
+void preemptIfNeeded()
 {
-	nodeList *n = current;
-	removeProcess(n->p);
-	prev->next = current->next;
-	current = current->next;
-	setNextCurrent();
-	free((void *)n);
-	increaseQuantum();
-	_changeProcess(getProcessRsp(current->p));
+	if (needResched)
+		_yieldProcess();
+}
+
+int isSchedulerRunning()
+{
+	return current != NULL;
 }
 
+/* Cambia la politica de p. init queda siempre en la ronda: es el que
+** corre cuando no hay nadie mas. */
+int setSchedAttr(process *p, schedAttr *attr)
+{
+	nodeList *node, *n;
+	uint64_t utilization = 0;
 
-void yieldProcess()
+	if (p == NULL || (node = p->schedNode) == NULL || (p->pid == 0 && !isThread(p) && attr->policy != SCHED_FAIR))
+		return 0;
+
+	switch (attr->policy)
+	{
+	case SCHED_FAIR:
+		break;
+	case SCHED_FIFO:
+		if (attr->priority < MIN_RT_PRIORITY || attr->priority > MAX_RT_PRIORITY)
+			return 0;
+		break;
+	case SCHED_DEADLINE:
+		if (attr->runtime == 0 || attr->period < attr->runtime)
+			return 0;
+		/* Admision: que entren todas las tareas EDF */
+		for (n = realTimeList; n != NULL; n = n->next)
+			if (n != node && n->attr.policy == SCHED_DEADLINE)
+				utilization += n->attr.runtime * 1000 / n->attr.period;
+		if (utilization + attr->runtime * 1000 / attr->period > RT_UTILIZATION)
+			return 0;
+		break;
+	default:
+		return 0;
+	}
+
+	node->class->dequeue(node);
+	node->attr = *attr;
+	node->class = attr->policy == SCHED_FAIR ? &fairClass : &realTimeClass;
+	node->class->enqueue(node);
+
+	/* Elegir de nuevo al terminar la syscall si el actual pudo perder
+	** prioridad o si p ahora le pasa adelante */
+	if (current != NULL && (node == current || (node->class == &realTimeClass && isRunnable(node) &&
+		(current->class != &realTimeClass || isBetter(node, current)))))
+		needResched = 1;
+	return 1;
+}
+
+int getSchedAttr(process *p, schedAttr *attr)
 {
-	current->next->quantum += 1;
-	current->quantum = 0;
-	_yieldProcess();
+	if (p == NULL || p->schedNode == NULL)
+		return 0;
+
+	*attr = p->schedNode->attr;
+	return 1;
+}
+
+static nodeList *pickNext()
+{
+	nodeList *next;
+	int i;
+
+	for (i = 0; i < CLASSES; i++)
+		if ((next = classes[i]->pickNext()) != NULL)
+			return next;
+
+	return current;
+}
+
+static void handOff()
+{
+	process *p = handoff;
+
+	handoff = NULL;
+	if (p->schedNode != NULL && !isProcessDeleted(p))
+		runNext(p->schedNode, donatedQuantum);
+}
+
+/* Pone a target a continuacion del actual y le da su turno. Solo
+** dentro de la ronda. */
+static void runNext(nodeList *target, int quantum)
+{
+	nodeList *n;
+
+	if (!isRunnable(target) || target->class != &fairClass || current->class != &fairClass ||
+		fairCursor == NULL || fairCursor == target)
+		return;
+
+	for (n = fairCursor; n->next != target; n = n->next)
+		;
+	if (n != fairCursor)
+	{
+		n->next = target->next;
+		target->next = fairCursor->next;
+		fairCursor->next = target;
+	}
+	target->quantum = quantum;
+	fairCursor->quantum = 0;
 }
 
-static void setNextCurrent()
+/* Menor cpu usada entre los listos de la ronda. El recorrido vuelve al
+** cursor porque este nunca queda fuera de la ronda, ver fairPickNext. */
+static uint64_t fairMinVruntime(nodeList *except)
 {
-	while (isProcessBlocked(current->p) || isProcessDeleted(current->p))
+	nodeList *n = fairCursor;
+	uint64_t min = 0;
+	int found = 0;
+
+	if (n == NULL)
+		return 0;
+
+	do
 	{
-		nodeList *next = current->next;
+		if (n != except && isRunnable(n) && !isProcessDeleted(n->p) && (!found || n->vruntime < min))
+		{
+			min = n->vruntime;
+			found = 1;
+		}
+		n = n->next;
+	} while (n != fairCursor);
+
+	return found ? min : fairCursor->vruntime;
+}
+
+static void fairEnqueue(nodeList *node)
+{
+	node->quantum = QUANTUM;
+	node->vruntime = fairMinVruntime(node);
+
+	if (fairCursor == NULL)
+	{
+		fairCursor = node;
+		node->next = node;
+	}
+	else
+	{
+		node->next = fairCursor->next;
+		fairCursor->next = node;
+	}
+}
+
+/* Si sale el cursor, la ronda sigue por el que estaba despues */
+static void fairDequeue(nodeList *node)
+{
+	nodeList *prev;
+
+	for (prev = node; prev->next != node; prev = prev->next)
+		;
+	prev->next = node->next;
+	if (preemptor == node)
+		preemptor = NULL;
 
-		if (isProcessDeleted(current->p))
+	if (fairCursor == node)
+	{
+		fairCursor = prev == node ? NULL : prev;
+		if (fairCursor != NULL)
+			fairCursor->quantum = 0;
+	}
+}
+
+static nodeList *fairPickNext()
+{
+	nodeList *prev;
+
+	if (fairCursor == NULL)
+		return NULL;
+	if (fairCursor->quantum > 0 && isRunnable(fairCursor) && !isProcessDeleted(fairCursor->p))
+		return fairCursor;
+
+	fairCursor->quantum = QUANTUM;
+	prev = fairCursor;
+	fairCursor = fairCursor->next;
+
+	while (!isRunnable(fairCursor) || isProcessDeleted(fairCursor->p))
+	{
+		nodeList *next = fairCursor->next;
+
+		if (isProcessDeleted(fairCursor->p))
 		{
+			nodeList *dead = fairCursor;
+
+			/* El cursor vuelve a la ronda antes de que removeProcess
+			** despierte a alguien y se recorra desde el */
 			prev->next = next;
-			removeProcess(current->p);
-			free((void *)current);
+			fairCursor = next;
+			releaseNode(dead);
 		}
 		else
-			prev = current;
+		{
+			prev = fairCursor;
+			fairCursor = next;
+		}
+	}
 
-		current = next;
+	return fairCursor;
+}
+
+static void fairTick(nodeList *running)
+{
+	if (running != NULL)
+	{
+		running->quantum--;
+		running->vruntime++;
 	}
 }
 
+static void fairYield(nodeList *node)
+{
+	node->quantum = 0;
+}
+
+static void realTimeEnqueue(nodeList *node)
+{
+	node->order = ++realTimeOrder;
+	node->remaining = node->attr.runtime;
+	node->deadline = ticks_elapsed() + node->attr.period;
+	node->next = realTimeList;
+	realTimeList = node;
+}
+
+static void realTimeDequeue(nodeList *node)
+{
+	nodeList **link;
+
+	for (link = &realTimeList; *link != NULL; link = &(*link)->next)
+	{
+		if (*link == node)
+		{
+			*link = node->next;
+			return;
+		}
+	}
+}
+
+/* Primero EDF por vencimiento, despues FIFO por prioridad y llegada */
+static nodeList *realTimePickNext()
+{
+	nodeList **link = &realTimeList, *n, *best = NULL;
+
+	while ((n = *link) != NULL)
+	{
+		if (isProcessDeleted(n->p))
+		{
+			*link = n->next;
+			releaseNode(n);
+			continue;
+		}
+		if (isRunnable(n) && (n->attr.policy == SCHED_FIFO || n->remaining > 0) && isBetter(n, best))
+			best = n;
+		link = &n->next;
+	}
+
+	return realTimeTicks < RT_LIMIT ? best : NULL;
+}
+
+/* Para un nodo ya sacado de su clase */
+static void releaseNode(nodeList *node)
+{
+	if (preemptor == node)
+		preemptor = NULL;
+	removeProcess(node->p);
+	if (node == current)
+		retired = node;
+	else
+		free((void *)node);
+}
+
+static int isBetter(nodeList *node, nodeList *best)
+{
+	if (best == NULL)
+		return 1;
+	if (node->attr.policy != best->attr.policy)
+		return node->attr.policy == SCHED_DEADLINE;
+	if (node->attr.policy == SCHED_DEADLINE)
+		return node->deadline < best->deadline;
+	if (node->attr.priority != best->attr.priority)
+		return node->attr.priority > best->attr.priority;
+	return node->order < best->order;
+}
+
+static void realTimeTick(nodeList *running)
+{
+	uint64_t now = ticks_elapsed();
+	nodeList *n;
+
+	if (now - windowStart >= RT_WINDOW)
+	{
+		windowStart = now;
+		realTimeTicks = 0;
+	}
+
+	if (running != NULL)
+	{
+		realTimeTicks++;
+		if (running->attr.policy == SCHED_DEADLINE && running->remaining > 0)
+			running->remaining--;
+	}
+
+	/* Cada periodo EDF empieza con el presupuesto completo */
+	for (n = realTimeList; n != NULL; n = n->next)
+	{
+		if (n->attr.policy == SCHED_DEADLINE && now >= n->deadline)
+		{
+			n->remaining = n->attr.runtime;
+			n->deadline = now + n->attr.period;
+		}
+	}
+}
+
+/* FIFO va al final de su prioridad, EDF deja lo que le queda del periodo */
+static void realTimeYield(nodeList *node)
+{
+	if (node->attr.policy == SCHED_DEADLINE)
+		node->remaining = 0;
+	else
+		node->order = ++realTimeOrder;
+}
+
 void printBlockedProcessesList()
 {
 	blockedProcess *temp = firstBlockedProcess;
@@ -147,6 +602,7 @@ void block(queueADT queue)
   enqueue(queue, current);
 }
 
+/* Los bloqueados siguen en su clase, alcanza con desbloquearlos */
 void unblock(queueADT queue)
 {
 	nodeList *node = dequeue(queue);
@@ -155,9 +611,9 @@ void unblock(queueADT queue)
 		if(node->p->status == DELETE)
 		{
 			unblock(queue);
+			return;
 		}
 
-		unblockProcess(current->p);
-		addProcess(current->p);
+		unblockProcess(node->p);
 	}
 }
@@ -0,0 +1,106 @@
+#include <sharedMemory.h>
+#include <pageAllocator.h>
+#include <scheduler.h>
+#include <lib.h>
+
+typedef struct
+{
+	int users; /* Processes attached, 0 if the slot is free */
+	char name[MAX_SHM_NAME];
+	void *base;
+	uint64_t size;
+} region;
+
+static region *findRegion(const char *name);
+static void detach(process *p, int index);
+
+static region regions[MAX_SHM_REGIONS];
+
+/* Attaches the current process to the region name, creating it zeroed
+** if it doesn't exist. Opening it again from the same process doesn't
+** take another reference. Returns NULL if size doesn't fit or there is
+** no memory left for it. */
+void *shmOpen(const char *name, uint64_t size)
+{
+	process *p = getCurrentProcess();
+	region *r;
+	int i;
+
+	if (p->leader != NULL)
+		p = p->leader;
+	if (size == 0 || size > MAX_SHM_SIZE || strlenKernel(name) >= MAX_SHM_NAME)
+		return NULL;
+
+	if ((r = findRegion(name)) == NULL)
+	{
+		for (i = 0; i < MAX_SHM_REGIONS && regions[i].users > 0; i++)
+			;
+		/* malloc halts instead of failing when pages run out */
+		if (i == MAX_SHM_REGIONS || !(size > PAGE_SIZE ? hasStackPage() : hasAvailablePage()))
+			return NULL;
+
+		r = &regions[i];
+		strcpyKernel(r->name, name);
+		r->base = malloc(size);
+		r->size = size;
+		memset(r->base, 0, size);
+	}
+	else if (size > r->size)
+		return NULL;
+
+	i = r - regions;
+	if (!(p->sharedMemory & (1 << i)))
+	{
+		p->sharedMemory |= 1 << i;
+		r->users++;
+	}
+	return r->base;
+}
+
+/* Detaches the current process, the last one frees the pages */
+int shmClose(void *address)
+{
+	process *p = getCurrentProcess();
+	int i;
+
+	if (p->leader != NULL)
+		p = p->leader;
+
+	for (i = 0; i < MAX_SHM_REGIONS; i++)
+	{
+		if (regions[i].users > 0 && regions[i].base == address && (p->sharedMemory & (1 << i)))
+		{
+			detach(p, i);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Called when the process is released */
+void shmReleaseProcess(process *p)
+{
+	int i;
+
+	for (i = 0; i < MAX_SHM_REGIONS; i++)
+		if (p->sharedMemory & (1 << i))
+			detach(p, i);
+}
+
+static region *findRegion(const char *name)
+{
+	int i;
+
+	for (i = 0; i < MAX_SHM_REGIONS; i++)
+		if (regions[i].users > 0 && strcmpKernel(regions[i].name, name) == 0)
+			return &regions[i];
+
+	return NULL;
+}
+
+static void detach(process *p, int index)
+{
+	p->sharedMemory &= ~(1 << index);
+	if (--regions[index].users == 0)
+		free(regions[index].base);
+}
@@ -0,0 +1,86 @@
+#include <soundDriver.h>
+#include <interrupts.h>
+#include <lib.h>
+#include <time.h>
+
+#define PIT_FREQUENCY 1193182
+
+typedef struct
+{
+	uint32_t frequency; /* 0 is a silence */
+	uint32_t ticks;
+} tone;
+
+static void startTone(tone *next);
+static uint32_t divisor(uint32_t frequency);
+
+static tone queue[TONE_QUEUE_SIZE];
+static int first = 0;
+static int queued = 0;
+
+static tone current;
+static uint32_t remaining = 0; /* Ticks left of the current tone */
+
+/* Queues a tone and returns right away, the timer tick plays it.
+** Durations are rounded up to ticks. Returns 0 if the queue is full. */
+int playTone(uint32_t frequency, uint32_t millis)
+{
+	uint64_t flags = _disableInterrupts();
+	tone next = {frequency, millis_to_ticks(millis)};
+	int result = queued < TONE_QUEUE_SIZE;
+
+	if (next.ticks == 0)
+		next.ticks = 1;
+
+	if (result && remaining == 0)
+		startTone(&next);
+	else if (result)
+	{
+		queue[(first + queued) % TONE_QUEUE_SIZE] = next;
+		queued++;
+	}
+
+	_restoreInterrupts(flags);
+	return result;
+}
+
+/* Channel 2 is shared, this sets the current tone again after someone
+** else used it */
+void restartTone()
+{
+	if (remaining > 0 && divisor(current.frequency) != 0)
+		speakerOn(divisor(current.frequency));
+	else
+		speakerOff();
+}
+
+void sound_handler()
+{
+	if (remaining == 0 || --remaining > 0)
+		return;
+
+	if (queued == 0)
+	{
+		speakerOff();
+		return;
+	}
+
+	startTone(&queue[first]);
+	first = (first + 1) % TONE_QUEUE_SIZE;
+	queued--;
+}
+
+static void startTone(tone *next)
+{
+	current = *next;
+	remaining = current.ticks;
+	restartTone();
+}
+
+/* 0 for silences and what the PIT can't divide to */
+static uint32_t divisor(uint32_t frequency)
+{
+	if (frequency == 0 || PIT_FREQUENCY / frequency > 0xFFFF)
+		return 0;
+	return PIT_FREQUENCY / frequency;
+}
@@ -7,9 +7,24 @@
 #include <processes.h>
 #include <scheduler.h>
 #include <mutex.h>
+#include <programLoader.h>
+#include <bmfs.h>
+#include <pageCache.h>
+#include <bootTimer.h>
+#include <soundDriver.h>
+#include <futex.h>
+#include <condition.h>
+#include <rwlock.h>
+#include <ipc.h>
+#include <time.h>
+#include <sharedMemory.h>
+#include <ring.h>
+#include <barrier.h>
+#include <cpuGroup.h>
+#include <systemCallDispatcher.h>
 
 static uint64_t _getTime(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
-static uint64_t _readChar(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _readChar(uint64_t wait, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
 static uint64_t _writeChar(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
 static uint64_t _beepSound(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
 static uint64_t _memalloc(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
@@ -30,6 +45,53 @@ static uint64_t _mutexUnlock(uint64_t mutex, uint64_t rdx, uint64_t rcx, uint64_
 static uint64_t _mutexLock(uint64_t mutex, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
 static uint64_t _getPid(uint64_t mutex, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
 static uint64_t _mutexClose(uint64_t mutex, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _spawn(uint64_t name, uint64_t argc, uint64_t argv, uint64_t quota, uint64_t r9);
+static uint64_t _open(uint64_t name, uint64_t flags, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _read(uint64_t fd, uint64_t buffer, uint64_t length, uint64_t r8, uint64_t r9);
+static uint64_t _write(uint64_t fd, uint64_t buffer, uint64_t length, uint64_t r8, uint64_t r9);
+static uint64_t _close(uint64_t fd, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _mmap(uint64_t fd, uint64_t offset, uint64_t length, uint64_t r8, uint64_t r9);
+static uint64_t _msync(uint64_t address, uint64_t length, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _munmap(uint64_t address, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _bootTimes(uint64_t times, uint64_t count, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _playTone(uint64_t frequency, uint64_t millis, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _threadCreate(uint64_t start, uint64_t function, uint64_t argument, uint64_t r8, uint64_t r9);
+static uint64_t _threadJoin(uint64_t tid, uint64_t result, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _threadExit(uint64_t result, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _futexWait(uint64_t address, uint64_t expected, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _futexWake(uint64_t address, uint64_t count, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _conditionInit(uint64_t name, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _conditionWait(uint64_t cond, uint64_t mutex, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _conditionSignal(uint64_t cond, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _conditionBroadcast(uint64_t cond, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _conditionClose(uint64_t cond, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _rwlockInit(uint64_t name, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _readLock(uint64_t lock, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _readUnlock(uint64_t lock, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _writeLock(uint64_t lock, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _writeUnlock(uint64_t lock, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _rwlockClose(uint64_t lock, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _call(uint64_t server, uint64_t request, uint64_t reply, uint64_t r8, uint64_t r9);
+static uint64_t _replyAndWait(uint64_t client, uint64_t reply, uint64_t request, uint64_t r8, uint64_t r9);
+static uint64_t _yieldTo(uint64_t pid, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _poll(uint64_t entries, uint64_t count, uint64_t millis, uint64_t r8, uint64_t r9);
+static uint64_t _tryReceive(uint64_t pid, uint64_t dest, uint64_t length, uint64_t r8, uint64_t r9);
+static uint64_t _trySend(uint64_t pid, uint64_t msg, uint64_t length, uint64_t r8, uint64_t r9);
+static uint64_t _queueStats(uint64_t pid, uint64_t stats, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _multicast(uint64_t pids, uint64_t count, uint64_t msg, uint64_t length, uint64_t r9);
+static uint64_t _shmOpen(uint64_t name, uint64_t size, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _shmClose(uint64_t address, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _ringSetup(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _ringEnter(uint64_t minComplete, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _barrierInit(uint64_t name, uint64_t count, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _barrierWait(uint64_t barrier, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _barrierClose(uint64_t barrier, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _schedSetAttr(uint64_t id, uint64_t attr, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _schedGetAttr(uint64_t id, uint64_t attr, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _setCpuQuota(uint64_t pid, uint64_t percent, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _getCpuQuota(uint64_t pid, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _exit(uint64_t status, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9);
+static uint64_t _waitpid(uint64_t pid, uint64_t status, uint64_t flags, uint64_t r8, uint64_t r9);
 
 
 static uint64_t (*systemCall[])(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9) = {_getTime,                         //0
@@ -53,13 +115,70 @@ static uint64_t (*systemCall[])(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64
 																										 _mutexLock, //18
 																										 _setProcessForeground, //19
 																										 _getPid, //20
-																										 _mutexClose //21
+																										 _mutexClose, //21
+																										 _spawn, //22
+																										 _open, //23
+																										 _read, //24
+																										 _write, //25
+																										 _close, //26
+																										 _mmap, //27
+																										 _msync, //28
+																										 _munmap, //29
+																										 _bootTimes, //30
+																										 _playTone, //31
+																										 _threadCreate, //32
+																										 _threadJoin, //33
+																										 _threadExit, //34
+																										 _futexWait, //35
+																										 _futexWake, //36
+																										 _conditionInit, //37
+																										 _conditionWait, //38
+																										 _conditionSignal, //39
+																										 _conditionBroadcast, //40
+																										 _conditionClose, //41
+																										 _rwlockInit, //42
+																										 _readLock, //43
+																										 _readUnlock, //44
+																										 _writeLock, //45
+																										 _writeUnlock, //46
+																										 _rwlockClose, //47
+																										 _call, //48
+																										 _replyAndWait, //49
+																										 _yieldTo, //50
+																										 _poll, //51
+																										 _tryReceive, //52
+																										 _trySend, //53
+																										 _queueStats, //54
+																										 _multicast, //55
+																										 _shmOpen, //56
+																										 _shmClose, //57
+																										 _ringSetup, //58
+																										 _ringEnter, //59
+																										 _barrierInit, //60
+																										 _barrierWait, //61
+																										 _barrierClose, //62
+																										 _schedSetAttr, //63
+																										 _schedGetAttr, //64
+																										 _setCpuQuota, //65
+																										 _getCpuQuota, //66
+																										 _exit, //67
+																										 _waitpid //68
 																									   };
 
 
 uint64_t systemCallDispatcher(uint64_t rdi, uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9)
 {
-	return (*systemCall[rdi])(rsi, rdx, rcx, r8, r9);
+	uint64_t result;
+
+	if (rdi >= sizeof(systemCall) / sizeof(systemCall[0]))
+		return -1;
+	result = (*systemCall[rdi])(rsi, rdx, rcx, r8, r9);
+	/* Lo mataron mientras tenia un lock, ver deferDeletion */
+	if (isProcessDeleted(getCurrentProcess()))
+		killProcess();
+	/* Si la syscall desperto a alguien que va antes, corre ya */
+	preemptIfNeeded();
+	return result;
 }
 
 static uint64_t _getTime(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9)
@@ -67,11 +186,15 @@ static uint64_t _getTime(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8,
 	return getTimeRTC(rsi);
 }
 
-static uint64_t _readChar(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9)
+/* Con wait duerme hasta que haya una tecla y el proceso este en
+** foreground, asi el teclado lo despierta en vez de que consulte */
+static uint64_t _readChar(uint64_t wait, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9)
 {
-	if(!isProcessRunningInForeground())
-		return 0;
-	return getChar();
+	int c;
+
+	while ((c = isProcessRunningInForeground() ? getChar() : EOF) == EOF && wait)
+		waitForKey();
+	return c;
 }
 
 static uint64_t _writeChar(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9)
@@ -84,8 +207,7 @@ static uint64_t _writeChar(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8
 
 static uint64_t _beepSound(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9)
 {
-	speakerBeep();
-	return 1;
+	return playTone(BEEP_FREQUENCY, BEEP_MILLIS);
 }
 
 static uint64_t _memalloc(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
@@ -136,18 +258,26 @@ static uint64_t _memFree(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8,
 
 static uint64_t _send(uint64_t pid, uint64_t msg, uint64_t length, uint64_t r8, uint64_t r9){
 	int owner = getProcessPid(getCurrentProcess());
-	sendMessage(getMessageQueue(pid), owner, (char*)msg, length);
-	return 1;
+	if (getProcessByPid(pid) == NULL || !prefaultRange(msg, length))
+		return -1;
+	return sendMessage(getMessageQueue(pid), owner, (char*)msg, length, 1);
 }
 
 static uint64_t _receive(uint64_t pid, uint64_t dest, uint64_t length, uint64_t r8, uint64_t r9){
 	int owner = getProcessPid(getCurrentProcess());
-	receiveMessage(getMessageQueue(owner), pid, (char*)dest, length);
-	return 1;
+	if (!prefaultRange(dest, length))
+		return -1;
+	return receiveMessage(getMessageQueue(owner), pid, (char*)dest, length);
 }
 
-static uint64_t _execProcess(uint64_t pointer, uint64_t argc, uint64_t argv, uint64_t name, uint64_t r9){
+/* Con quota entre 1 y 99 el proceso arranca en un grupo limitado a ese
+** porcentaje de la cpu, antes de que pueda correr o crear hijos */
+static uint64_t _execProcess(uint64_t pointer, uint64_t argc, uint64_t argv, uint64_t name, uint64_t quota){
 	process *p = createProcess(pointer, argc, argv, (char*)name);
+	if (p == NULL)
+		return -1;
+	if (quota != 0)
+		setCpuQuota(p, quota);
 	runProcess(p);
 	return getProcessPid(p);
 }
@@ -187,3 +317,256 @@ static uint64_t _getPid(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, u
 	process * p = getCurrentProcess();
 	return getProcessPid(p);
 }
+
+static uint64_t _spawn(uint64_t name, uint64_t argc, uint64_t argv, uint64_t quota, uint64_t r9){
+	int pid = spawnProgram((char*)name, argc, argv);
+	if (pid >= 0 && quota != 0)
+		setCpuQuota(getProcessByPid(pid), quota);
+	return pid;
+}
+
+static uint64_t _open(uint64_t name, uint64_t flags, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return bmfsOpen((char*)name, (int)flags);
+}
+
+static uint64_t _read(uint64_t fd, uint64_t buffer, uint64_t length, uint64_t r8, uint64_t r9){
+	if (!prefaultRange(buffer, length))
+		return -1;
+	return bmfsRead((int)fd, (void*)buffer, length);
+}
+
+static uint64_t _write(uint64_t fd, uint64_t buffer, uint64_t length, uint64_t r8, uint64_t r9){
+	if (!prefaultRange(buffer, length))
+		return -1;
+	return bmfsWrite((int)fd, (void*)buffer, length);
+}
+
+static uint64_t _close(uint64_t fd, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return bmfsClose((int)fd);
+}
+
+static uint64_t _mmap(uint64_t fd, uint64_t offset, uint64_t length, uint64_t r8, uint64_t r9){
+	return mmapFile((int)fd, offset, length);
+}
+
+static uint64_t _msync(uint64_t address, uint64_t length, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return msyncFile(address, length);
+}
+
+static uint64_t _munmap(uint64_t address, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return munmapFile(address);
+}
+
+static uint64_t _bootTimes(uint64_t times, uint64_t count, uint64_t rcx, uint64_t r8, uint64_t r9){
+	if (count > BOOT_PHASES)
+		count = BOOT_PHASES;
+	if (!prefaultRange(times, count * sizeof(bootTime)))
+		return 0;
+	return getBootTimes((bootTime*)times, (int)count);
+}
+
+static uint64_t _playTone(uint64_t frequency, uint64_t millis, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return playTone((uint32_t)frequency, (uint32_t)millis);
+}
+
+static uint64_t _threadCreate(uint64_t start, uint64_t function, uint64_t argument, uint64_t r8, uint64_t r9){
+	process *thread = createThread(start, function, argument);
+	if (thread == NULL)
+		return -1;
+	runProcess(thread);
+	return thread->tid;
+}
+
+static uint64_t _threadJoin(uint64_t tid, uint64_t result, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return joinThread(tid, (uint64_t*)result);
+}
+
+static uint64_t _threadExit(uint64_t result, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	exitThread(result);
+	return 1;
+}
+
+static uint64_t _futexWait(uint64_t address, uint64_t expected, uint64_t rcx, uint64_t r8, uint64_t r9){
+	if (!prefaultRange(address, sizeof(int)))
+		return -1;
+	return futexWait((int*)address, (int)expected);
+}
+
+static uint64_t _futexWake(uint64_t address, uint64_t count, uint64_t rcx, uint64_t r8, uint64_t r9){
+	if (!prefaultRange(address, sizeof(int)))
+		return -1;
+	return futexWake((int*)address, (int)count);
+}
+
+static uint64_t _conditionInit(uint64_t name, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return (uint64_t)conditionInit((void*)name);
+}
+
+static uint64_t _conditionWait(uint64_t cond, uint64_t mutex, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return conditionWait((void*)cond, (void*)mutex);
+}
+
+static uint64_t _conditionSignal(uint64_t cond, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return conditionSignal((void*)cond);
+}
+
+static uint64_t _conditionBroadcast(uint64_t cond, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return conditionBroadcast((void*)cond);
+}
+
+static uint64_t _conditionClose(uint64_t cond, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return conditionClose((void*)cond);
+}
+
+static uint64_t _rwlockInit(uint64_t name, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return (uint64_t)rwlockInit((void*)name);
+}
+
+static uint64_t _readLock(uint64_t lock, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return readLock((void*)lock);
+}
+
+static uint64_t _readUnlock(uint64_t lock, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return readUnlock((void*)lock);
+}
+
+static uint64_t _writeLock(uint64_t lock, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return writeLock((void*)lock);
+}
+
+static uint64_t _writeUnlock(uint64_t lock, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return writeUnlock((void*)lock);
+}
+
+static uint64_t _rwlockClose(uint64_t lock, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return rwlockClose((void*)lock);
+}
+
+static uint64_t _call(uint64_t server, uint64_t request, uint64_t reply, uint64_t r8, uint64_t r9){
+	if (!prefaultRange(request, sizeof(ipcMessage)) || !prefaultRange(reply, sizeof(ipcMessage)))
+		return -1;
+	return ipcCall(server, (ipcMessage*)request, (ipcMessage*)reply);
+}
+
+static uint64_t _replyAndWait(uint64_t client, uint64_t reply, uint64_t request, uint64_t r8, uint64_t r9){
+	if (!prefaultRange(reply, sizeof(ipcMessage)) || !prefaultRange(request, sizeof(ipcMessage)))
+		return -1;
+	return ipcReplyAndWait((int64_t)client, (ipcMessage*)reply, (ipcMessage*)request);
+}
+
+static uint64_t _yieldTo(uint64_t pid, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return yieldTo(getTaskById(pid)) ? 0 : -1;
+}
+
+/* millis negativo espera para siempre */
+static uint64_t _poll(uint64_t entries, uint64_t count, uint64_t millis, uint64_t r8, uint64_t r9){
+	int owner = getProcessPid(getCurrentProcess());
+	int timeout = (int)millis;
+
+	if (!prefaultRange(entries, count * sizeof(pollEntry)))
+		return -1;
+	if (timeout > 0)
+		timeout = millis_to_ticks(timeout);
+	return pollMessages(getMessageQueue(owner), (pollEntry*)entries, (int)count, timeout);
+}
+
+static uint64_t _tryReceive(uint64_t pid, uint64_t dest, uint64_t length, uint64_t r8, uint64_t r9){
+	int owner = getProcessPid(getCurrentProcess());
+	if (!prefaultRange(dest, length))
+		return -1;
+	return tryReceiveMessage(getMessageQueue(owner), pid, (char*)dest, length);
+}
+
+/* Como send pero devuelve 0 si la cola del destino esta llena */
+static uint64_t _trySend(uint64_t pid, uint64_t msg, uint64_t length, uint64_t r8, uint64_t r9){
+	int owner = getProcessPid(getCurrentProcess());
+	if (getProcessByPid(pid) == NULL || !prefaultRange(msg, length))
+		return -1;
+	return sendMessage(getMessageQueue(pid), owner, (char*)msg, length, 0);
+}
+
+static uint64_t _queueStats(uint64_t pid, uint64_t stats, uint64_t rcx, uint64_t r8, uint64_t r9){
+	if (getProcessByPid(pid) == NULL || !prefaultRange(stats, sizeof(queueStats)))
+		return 0;
+	getQueueStats(getMessageQueue(pid), (queueStats*)stats);
+	return 1;
+}
+
+static uint64_t _multicast(uint64_t pids, uint64_t count, uint64_t msg, uint64_t length, uint64_t r9){
+	int owner = getProcessPid(getCurrentProcess());
+	if (count > MAX_PROCESSES || !prefaultRange(pids, count * sizeof(int)) || !prefaultRange(msg, length))
+		return 0;
+	return multicastMessage((int*)pids, (int)count, owner, (char*)msg, (int)length);
+}
+
+static uint64_t _shmOpen(uint64_t name, uint64_t size, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return (uint64_t)shmOpen((const char*)name, size);
+}
+
+static uint64_t _shmClose(uint64_t address, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return shmClose((void*)address);
+}
+
+static uint64_t _ringSetup(uint64_t rsi, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return (uint64_t)ringSetup();
+}
+
+static uint64_t _ringEnter(uint64_t minComplete, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return ringEnter(minComplete);
+}
+
+static uint64_t _barrierInit(uint64_t name, uint64_t count, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return (uint64_t)barrierInit((void*)name, (int)count);
+}
+
+static uint64_t _barrierWait(uint64_t barrier, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return barrierWait((void*)barrier);
+}
+
+static uint64_t _barrierClose(uint64_t barrier, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	return barrierClose((void*)barrier);
+}
+
+/* Los tiempos llegan en milisegundos, el scheduler usa ticks */
+static uint64_t _schedSetAttr(uint64_t id, uint64_t attr, uint64_t rcx, uint64_t r8, uint64_t r9){
+	schedAttr copy;
+	if (!prefaultRange(attr, sizeof(schedAttr)))
+		return 0;
+	copy = *(schedAttr*)attr;
+	copy.runtime = millis_to_ticks(copy.runtime);
+	copy.period = millis_to_ticks(copy.period);
+	/* Si hace falta, se cambia de proceso en preemptIfNeeded */
+	return setSchedAttr(getTaskById(id), &copy);
+}
+
+static uint64_t _schedGetAttr(uint64_t id, uint64_t attr, uint64_t rcx, uint64_t r8, uint64_t r9){
+	schedAttr *out = (schedAttr*)attr;
+	if (!prefaultRange(attr, sizeof(schedAttr)) || !getSchedAttr(getTaskById(id), out))
+		return 0;
+	out->runtime = ticks_to_millis(out->runtime);
+	out->period = ticks_to_millis(out->period);
+	return 1;
+}
+
+/* init es el proceso ocioso, no se puede limitar */
+static uint64_t _setCpuQuota(uint64_t pid, uint64_t percent, uint64_t rcx, uint64_t r8, uint64_t r9){
+	if (pid == 0 || percent > 100)
+		return 0;
+	return setCpuQuota(getProcessByPid(pid), percent);
+}
+
+static uint64_t _getCpuQuota(uint64_t pid, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	process *p = getProcessByPid(pid);
+	return p == NULL ? -1 : getCpuQuota(p);
+}
+
+static uint64_t _exit(uint64_t status, uint64_t rdx, uint64_t rcx, uint64_t r8, uint64_t r9){
+	exitProcess((int)status);
+	return 0;
+}
+
+static uint64_t _waitpid(uint64_t pid, uint64_t status, uint64_t flags, uint64_t r8, uint64_t r9){
+	if (status != 0 && !prefaultRange(status, sizeof(int)))
+		return -1;
+	return waitProcess((int)pid, (int*)status, (int)flags);
+}
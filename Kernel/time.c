@@ -26,6 +26,15 @@ void seconds_delay(int seconds){
 	}while(actualSeconds<finalSecond);
 }
 
+/* Redondea para arriba, un timeout nunca dura menos de lo pedido */
+int millis_to_ticks(int millis){
+	return (millis * 18 + 999) / 1000;
+}
+
+int ticks_to_millis(int ticks){
+	return ticks * 1000 / 18;
+}
+
 void ticks_delay(int ticks){
 	int finalTick = ticks_elapsed() + ticks;
 	int actualTicks;
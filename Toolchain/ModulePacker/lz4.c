@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lz4.h"
+
+/* Greedy LZ4 block compressor. The output is decoded by
+** Kernel/lz4.c, so only the block format is produced (no frame). */
+
+#define HASH_LOG 16
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+/* The block format requires the last match to start at least 12 bytes
+** before the end and the last 5 bytes to be literals */
+#define MATCH_LIMIT 12
+#define LAST_LITERALS 5
+
+static uint32_t read32(const uint8_t *p) {
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static uint32_t hash(uint32_t sequence) {
+	return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+static uint8_t *write_length(uint8_t *op, uint32_t length) {
+	while (length >= 255) {
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = length;
+	return op;
+}
+
+static uint8_t *write_sequence(uint8_t *op, const uint8_t *literals, uint32_t literalLength,
+		uint32_t offset, uint32_t matchLength) {
+	uint8_t *token = op++;
+
+	*token = (literalLength < 15 ? literalLength : 15) << 4;
+	if (literalLength >= 15)
+		op = write_length(op, literalLength - 15);
+	memcpy(op, literals, literalLength);
+	op += literalLength;
+
+	if (matchLength == 0)
+		return op;
+
+	*op++ = offset & 0xFF;
+	*op++ = offset >> 8;
+	matchLength -= MIN_MATCH;
+	*token |= matchLength < 15 ? matchLength : 15;
+	if (matchLength >= 15)
+		op = write_length(op, matchLength - 15);
+	return op;
+}
+
+uint32_t lz4_bound(uint32_t size) {
+	return size + size / 255 + 16;
+}
+
+uint32_t lz4_compress(const uint8_t *source, uint32_t size, uint8_t *target) {
+	int64_t *table = malloc(sizeof(int64_t) << HASH_LOG);
+	uint8_t *op = target;
+	uint32_t ip = 0, anchor = 0;
+	int i;
+
+	if (table == NULL)
+		return 0;
+	for (i = 0 ; i < (1 << HASH_LOG) ; i++)
+		table[i] = -1;
+
+	while (size > MATCH_LIMIT && ip < size - MATCH_LIMIT) {
+		uint32_t sequence = read32(source + ip);
+		uint32_t h = hash(sequence);
+		int64_t ref = table[h];
+		table[h] = ip;
+
+		if (ref < 0 || ip - ref > MAX_OFFSET || read32(source + ref) != sequence) {
+			ip++;
+			continue;
+		}
+
+		uint32_t length = MIN_MATCH;
+		while (ip + length < size - LAST_LITERALS && source[ref + length] == source[ip + length])
+			length++;
+
+		op = write_sequence(op, source + anchor, ip - anchor, ip - ref, length);
+		ip += length;
+		anchor = ip;
+	}
+
+	op = write_sequence(op, source + anchor, size - anchor, 0, 0);
+	free(table);
+	return op - target;
+}
@@ -0,0 +1,13 @@
+#ifndef _LZ4_H_
+#define _LZ4_H_
+
+#include <stdint.h>
+
+/* Worst case size of a compressed block */
+uint32_t lz4_bound(uint32_t size);
+
+/* Compresses size bytes into target, which must hold lz4_bound(size)
+** bytes. Returns the compressed size, or 0 on failure. */
+uint32_t lz4_compress(const uint8_t *source, uint32_t size, uint8_t *target);
+
+#endif
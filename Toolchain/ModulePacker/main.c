@@ -3,9 +3,11 @@
 #include <stdint.h>
 #include <sys/stat.h>
 #include <stdlib.h>
+#include <string.h>
 #include <argp.h>
 
 #include "modulePacker.h"
+#include "lz4.h"
 
 //Parser elements
 const char *argp_program_version =
@@ -15,15 +17,23 @@ const char *argp_program_bug_address =
 
 /* Program documentation. */
 static char doc[] =
-  "ModulePacker is an appender of binary files to be loaded all together";
+  "ModulePacker is an appender of binary files to be loaded all together"
+  "\vA module given as FILE@ADDRESS is copied to ADDRESS by the kernel at boot; "
+  "a module without an address is used in place from the packed image. "
+  "With --compress, modules with an address are stored LZ4 compressed when that "
+  "makes them smaller; modules used in place are always stored as they are.";
 
 /* A description of the arguments we accept. */
-static char args_doc[] = "KernelFile Module1 Module2 ...";
+static char args_doc[] = "KernelFile Module1[@Address] Module2[@Address] ...";
 
 /* The options we understand. */
 static struct argp_option options[] = {
   {"output",   'o', "FILE", 0,
    "Output to FILE instead of standard output" },
+  {"compress", 'z', 0, 0,
+   "Compress modules that have a load address with LZ4" },
+  {"loader",   'l', "FILE", 0,
+   "Fail if FILE plus the image exceed what the MBR loads" },
   { 0 }
 };
 
@@ -37,53 +47,165 @@ int main(int argc, char *argv[]) {
 
 	arguments.output_file = OUTPUT_FILE;
 	arguments.count = 0;
+	arguments.compress = FALSE;
+	arguments.loader_file = NULL;
 
 	argp_parse (&argp, argc, argv, 0, 0, &arguments);
 
 	array_t fileArray = {arguments.args, arguments.count};
+	module_t modules[MAX_FILES];
+
+	int i;
+	for (i = 1 ; i < fileArray.length ; i++) {
+		parseModule(fileArray.array[i], &modules[i - 1]);
+	}
 
 	if(!checkFiles(fileArray)) {
 		return 1;
 	}	
 
-	return !buildImage(fileArray, arguments.output_file);
+	if (!buildImage(fileArray, modules, arguments.output_file, arguments.compress))
+		return 1;
+
+	return !checkImageSize(arguments.output_file, arguments.loader_file);
+}
+
+/* Removes the image if the MBR would load only part of it. */
+int checkImageSize(char *output_file, char *loader_file) {
+	struct stat loader, image;
+
+	if (loader_file == NULL)
+		return TRUE;
+
+	if (stat(loader_file, &loader) || stat(output_file, &image)) {
+		printf("Can't stat %s or %s\n", loader_file, output_file);
+		return FALSE;
+	}
+
+	if (loader.st_size + image.st_size > LOADER_LIMIT) {
+		printf("Image is %ld bytes, only %ld fit after %s\n",
+			(long) image.st_size, (long) (LOADER_LIMIT - loader.st_size), loader_file);
+		remove(output_file);
+		return FALSE;
+	}
+	return TRUE;
 }
 
-int buildImage(array_t fileArray, char *output_file) {
+int buildImage(array_t fileArray, module_t *modules, char *output_file, int compress) {
 
 	FILE *target;
+	int moduleCount = fileArray.length - 1;
+	moduleEntry entries[MAX_FILES];
+	uint8_t *contents[MAX_FILES];
+	moduleTable table = {MODULE_TABLE_MAGIC, moduleCount};
+	uint32_t offset;
+	int i, pass;
 
 	if((target = fopen(output_file, "w")) == NULL) {
 		printf("Can't create target file\n");
 		return FALSE;
 	}
 
-	//First, write the kernel
+	//First, write the kernel, padded so the module table starts on a page
 	FILE *source = fopen(fileArray.array[0], "r");
 	write_file(target, source);
-
-	//Write how many extra binaries we got.
-	int extraBinaries = fileArray.length - 1;
-	fwrite(&extraBinaries, sizeof(extraBinaries), 1, target);	
 	fclose(source);
+	write_padding(target, PAGE_SIZE);
+
+	//Lay out the payloads after the table, one page-aligned slot each.
+	//Modules used in place go first so the kernel can reclaim the rest.
+	offset = sizeof(table) + moduleCount * sizeof(moduleEntry);
+	for (pass = 0 ; pass < 2 ; pass++) {
+		for (i = 0 ; i < moduleCount ; i++) {
+			if ((modules[i].loadAddress == MODULE_IN_PLACE) != (pass == 0))
+				continue;
+
+			contents[i] = read_file(modules[i].path, &entries[i].size);
+			if (contents[i] == NULL) {
+				printf("Can't read file: %s\n", modules[i].path);
+				fclose(target);
+				return FALSE;
+			}
+
+			offset = (offset + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+			setModuleName(entries[i].name, modules[i].path);
+			entries[i].loadAddress = modules[i].loadAddress;
+			entries[i].offset = offset;
+			entries[i].checksum = adler32(contents[i], entries[i].size);
+			entries[i].packedSize = entries[i].size;
+			entries[i].flags = 0;
+			entries[i].reserved = 0;
+			//The kernel can't use a compressed module in place
+			if (compress && modules[i].loadAddress != MODULE_IN_PLACE)
+				compressModule(&entries[i], &contents[i]);
+			offset += entries[i].packedSize;
+		}
+	}
 
-	int i;
-	for (i = 1 ; i < fileArray.length ; i++) {
-		FILE *source = fopen(fileArray.array[i], "r");
-		
-		//Write the file size;
-		write_size(target, fileArray.array[i]);
+	fwrite(&table, sizeof(table), 1, target);
+	fwrite(entries, sizeof(moduleEntry), moduleCount, target);
+
+	//Write the payloads in offset order
+	for (pass = 0 ; pass < 2 ; pass++) {
+		for (i = 0 ; i < moduleCount ; i++) {
+			if ((modules[i].loadAddress == MODULE_IN_PLACE) != (pass == 0))
+				continue;
+			write_padding(target, PAGE_SIZE);
+			fwrite(contents[i], 1, entries[i].packedSize, target);
+			free(contents[i]);
+		}
+	}
 
-		//Write the binary
-		write_file(target, source);
+	fclose(target);
+	return TRUE;
+}
 
-		fclose(source);
+/* Replaces the contents with their LZ4 block if that is smaller. */
+int compressModule(moduleEntry *entry, uint8_t **contents) {
+	uint8_t *compressed = malloc(lz4_bound(entry->size));
+	uint32_t packedSize;
 
-	} 
-	fclose(target);
+	if (compressed == NULL)
+		return FALSE;
+
+	packedSize = lz4_compress(*contents, entry->size, compressed);
+	if (packedSize == 0 || packedSize >= entry->size) {
+		free(compressed);
+		return FALSE;
+	}
+
+	free(*contents);
+	*contents = compressed;
+	entry->packedSize = packedSize;
+	entry->flags |= MODULE_LZ4;
+	return TRUE;
+}
+
+/* Splits a FILE[@ADDRESS] argument, leaving FILE in place. */
+int parseModule(char *arg, module_t *module) {
+	char *at = strrchr(arg, '@');
+
+	module->path = arg;
+	module->loadAddress = MODULE_IN_PLACE;
+	if (at != NULL) {
+		*at = '\0';
+		module->loadAddress = strtoull(at + 1, NULL, 0);
+	}
 	return TRUE;
 }
 
+/* The module name is the file name without directories or extension. */
+void setModuleName(char *name, const char *path) {
+	const char *base = strrchr(path, '/');
+	char *extension;
+
+	base = (base == NULL) ? path : base + 1;
+	memset(name, 0, MODULE_NAME_LENGTH);
+	strncpy(name, base, MODULE_NAME_LENGTH - 1);
+	if ((extension = strrchr(name, '.')) != NULL)
+		*extension = '\0';
+}
+
 
 int checkFiles(array_t fileArray) {
 
@@ -98,11 +220,44 @@ int checkFiles(array_t fileArray) {
 
 }
 
-int write_size(FILE *target, char *filename) {
+uint8_t *read_file(char *filename, uint32_t *size) {
 	struct stat st;
-	stat(filename, &st);
-	uint32_t size = st.st_size;
-	fwrite(&size, sizeof(uint32_t), 1, target);
+	uint8_t *buffer;
+	FILE *source;
+
+	if (stat(filename, &st) || (source = fopen(filename, "r")) == NULL)
+		return NULL;
+
+	*size = st.st_size;
+	buffer = malloc(*size + 1);
+	if (buffer != NULL && fread(buffer, 1, *size, source) != *size) {
+		free(buffer);
+		buffer = NULL;
+	}
+	fclose(source);
+	return buffer;
+}
+
+
+int write_padding(FILE *target, long alignment) {
+	long position = ftell(target);
+
+	while (position++ % alignment)
+		fputc(0, target);
+
+	return TRUE;
+}
+
+
+/* Same checksum the kernel verifies in moduleLoader.c */
+uint32_t adler32(const uint8_t *data, uint32_t size) {
+	uint32_t a = 1, b = 0;
+
+	while (size--) {
+		a = (a + *data++) % 65521;
+		b = (b + a) % 65521;
+	}
+	return (b << 16) | a;
 }
 
 
@@ -133,6 +288,14 @@ parse_opt (int key, char *arg, struct argp_state *state)
       arguments->output_file = arg;
       break;
 
+    case 'z':
+      arguments->compress = TRUE;
+      break;
+
+    case 'l':
+      arguments->loader_file = arg;
+      break;
+
     case ARGP_KEY_ARG:
       arguments->args[state->arg_num] = arg;
       break;
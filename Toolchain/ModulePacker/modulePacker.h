@@ -2,6 +2,7 @@
 #define _MODULE_PACKER_H_
 
 #include <argp.h>
+#include <stdint.h>
 
 
 #define FALSE 0
@@ -13,6 +14,45 @@
 
 #define MAX_FILES 128
 
+#define PAGE_SIZE 0x1000
+
+/* The Pure64 MBR loads the loader plus the packed image: 512 sectors */
+#define LOADER_LIMIT (256 * 1024)
+
+/* Packed image layout, shared with Kernel/include/moduleLoader.h:
+**   kernel binary, padded to a page
+**   moduleTable followed by one moduleEntry per module
+**   module payloads, each starting on a page boundary
+*/
+#define MODULE_TABLE_MAGIC 0x324B504D /* "MPK2" */
+#define MODULE_NAME_LENGTH 32
+
+/* Modules without a load address are used in place from the image */
+#define MODULE_IN_PLACE 0
+
+/* moduleEntry flags */
+#define MODULE_LZ4 0x1	/* Payload is an LZ4 block of packedSize bytes */
+
+typedef struct {
+	uint32_t magic;
+	uint32_t count;
+} moduleTable;
+
+typedef struct {
+	char name[MODULE_NAME_LENGTH];
+	uint64_t loadAddress;
+	uint32_t offset;	/* From the start of the module table */
+	uint32_t size;
+	uint32_t packedSize;	/* Bytes of payload in the image */
+	uint32_t checksum;	/* Adler-32 of the module contents */
+	uint32_t flags;
+	uint32_t reserved;
+} moduleEntry;
+
+typedef struct {
+	char *path;
+	uint64_t loadAddress;
+} module_t;
 
 typedef struct {
 	char **array;
@@ -24,15 +64,28 @@ typedef struct {
 struct arguments
 {
   char *args[MAX_FILES];                
-  int silent, verbose;
+  int silent, verbose, compress;
   char *output_file;
+  char *loader_file;
   int count;
 };
 
 
-int buildImage(array_t fileArray, char *output_file);
+int buildImage(array_t fileArray, module_t *modules, char *output_file, int compress);
+
+int checkImageSize(char *output_file, char *loader_file);
+
+int compressModule(moduleEntry *entry, uint8_t **contents);
+
+int parseModule(char *arg, module_t *module);
+
+void setModuleName(char *name, const char *path);
+
+uint8_t *read_file(char *filename, uint32_t *size);
+
+int write_padding(FILE *target, long alignment);
 
-int write_size(FILE *target, char *filename);
+uint32_t adler32(const uint8_t *data, uint32_t size);
 
 int write_file(FILE *target, FILE *source);
 
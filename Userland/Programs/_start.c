@@ -0,0 +1,11 @@
+/* _start.c */
+#include <exitProcess.h>
+
+int main(int argc, char **argv);
+
+/* El kernel ya limpió el bss y aplicó las relocaciones */
+void _start(int argc, char **argv)
+{
+	main(argc, argv);
+	exitProcess();
+}
@@ -1,13 +1,71 @@
 #include <blobsBack.h>
+#include <files.h>
+#include <parallel.h>
 
+static void limpiaFila(int fila, void *partida);
+
+/* La partida se guarda en un archivo BMFS: modo de juego, turno, filas,
+** columnas y despues el tablero fila por fila. */
 int recuperarPartida(tipoPartida *partida){
-	
-  	return 1;
+	int archivo, i, j, datos[4];
+
+	archivo=open((*partida).s, 0);
+	if(archivo<0)
+		return 0;
+
+	if(read(archivo, datos, sizeof(datos))!=sizeof(datos) || datos[0]<0 || datos[0]>2 ||\
+	(datos[1]!=1 && datos[1]!=2) || datos[2]<=0 || datos[3]<=0){
+		close(archivo);
+		return 0;
+	}
+	(*partida).modojuego=datos[0];
+	(*partida).turno=datos[1];
+	(*partida).filas=datos[2];
+	(*partida).columnas=datos[3];
+
+	if(creaTableroVacio(partida)==1){
+		close(archivo);
+		return 0;
+	}
+
+	(*partida).manchasA=0;
+	(*partida).manchasZ=0;
+	for(i=0;i<(*partida).filas;i++){
+		if(read(archivo, (*partida).tablero[i], (*partida).columnas)!=(*partida).columnas){
+			liberaTablero(partida);
+			close(archivo);
+			return 0;
+		}
+		for(j=0;j<(*partida).columnas;j++){
+			if((*partida).tablero[i][j]=='A')
+				(*partida).manchasA++;
+			else if((*partida).tablero[i][j]=='Z')
+				(*partida).manchasZ++;
+		}
+	}
+
+	close(archivo);
+	return 1;
 }
 
 int guardarPartida(const tipoPartida *partida){
-	
-	return 1;
+	int archivo, i, resultado=1;
+	int datos[4]={(*partida).modojuego, (*partida).turno, (*partida).filas, (*partida).columnas};
+
+	archivo=open((*partida).s, O_CREATE | O_TRUNCATE);
+	if(archivo<0)
+		return 0;
+
+	if(write(archivo, datos, sizeof(datos))!=sizeof(datos))
+		resultado=0;
+	for(i=0;i<(*partida).filas && resultado==1;i++){
+		if(write(archivo, (*partida).tablero[i], (*partida).columnas)!=(*partida).columnas)
+			resultado=0;
+	}
+
+	if(!close(archivo))
+		resultado=0;
+	return resultado;
 }
 
 void liberaTablero(tipoPartida *partida){
@@ -54,6 +112,8 @@ int creaTablero(tipoPartida *partida){
 		if(*((*partida).tablero+i)==NULL)
 			return 1;
 	}
+	//las filas no vienen en cero de malloc, se limpian en paralelo
+	parallelFor((*partida).filas, limpiaFila, partida);
 	(*partida).tablero[0][0]='A';
 	(*partida).tablero[(*partida).filas-1][0]='A';
 	(*partida).tablero[0][(*partida).columnas-1]='Z';
@@ -61,6 +121,10 @@ int creaTablero(tipoPartida *partida){
 	return 0;
 }
 
+static void limpiaFila(int fila, void *partida){
+	memset(((tipoPartida *)partida)->tablero[fila], 0, ((tipoPartida *)partida)->columnas);
+}
+
 int muevePosicion(tipoPartida *partida){
 	int difFil, difCol, resultado;
 	char jugador, otrojugador;
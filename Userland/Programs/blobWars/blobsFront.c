@@ -14,7 +14,7 @@
 #define JUGADORUNO 1
 #define JUGADORDOS 2
 
-enum{JUGADORvsJUGADOR=1, JUGADORvsCOMPUTADORA, COMPUTADORAvsCOMPUTADORA, SALIR};
+enum{JUGADORvsJUGADOR=1, JUGADORvsCOMPUTADORA, COMPUTADORAvsCOMPUTADORA, RECUPERAR, SALIR};
 
 int menuJuego(tipoPartida *partida);
 void cantFilsyCols(tipoPartida *partida);
@@ -28,6 +28,10 @@ void leeNumero(int *numero, int desdeN, int hastaN);
 void leeNombre(tipoPartida *partida);
 int siOno();
 
+int main(int argc, char **argv){
+	return iniciarBlobWars();
+}
+
 int iniciarBlobWars(){
 	tipoPartida partida;
 	partida.s=malloc(MAXNOMBREARCHIVO);
@@ -47,10 +51,11 @@ int menuJuego(tipoPartida *partida){
 	printf("\n1. Juego de jugador contra jugador\n");
 	printf("2. Juego de jugador contra computadora\n");
 	printf("3. Juego de computadora contra computadora\n");
-	printf("4. Salir\n\n");
+	printf("4. Recuperar partida guardada\n");
+	printf("5. Salir\n\n");
 	printf("Elegir opcion: ");
 
-	leeNumero(&opcion, 1, 4);
+	leeNumero(&opcion, 1, 5);
 
 	while(flagDeExit==1 && flagDeError==0){
 		switch(opcion){
@@ -96,6 +101,23 @@ int menuJuego(tipoPartida *partida){
 					}
 				}
 			break;
+			case RECUPERAR:
+				printf("Ingrese el nombre de la partida: ");
+				leeNombre(partida);
+				if(recuperarPartida(partida)==0){
+					printf("No se pudo recuperar la partida.\n");
+					flagDeExit=0;
+					flagJuegaDeNuevo=1;
+				}
+				else{
+					flagDeExit=jugar(partida);
+					if(flagDeExit==0){
+						printf("¿Desea jugar denuevo?\n");
+						flagJuegaDeNuevo=siOno();
+						liberaTablero(partida);
+					}
+				}
+			break;
 			case SALIR:
 				flagDeExit=0;
 				flagJuegaDeNuevo=0;
@@ -339,6 +361,10 @@ int leeIngresado(tipoPartida *partida){
 				{
 					resultado = SALE_SIN_GUARDAR;
 				}
+				else if (flagRepite == 1 && !strcmp((*partida).s, "save"))
+				{
+					resultado = GUARDA_PARTIDA;
+				}
 				else{
 					flagRepite = 0;
 				}
@@ -357,8 +383,8 @@ int movimiento(tipoPartida *partida){
 
 	printf("Turno jugador %d(%c). ", (*partida).turno, JUGADORALETRA((*partida).turno));
 	printf("Acciones: ");
-	printf("[ff,cc][ff,cc] ");
-	printf("o quit\n");
+	printf("[ff,cc][ff,cc]");
+	printf(", save o quit\n");
 
 	do{
 		printf("Ingrese accion: ");
@@ -370,6 +396,14 @@ int movimiento(tipoPartida *partida){
 			else if(flagMovimiento==NO_EXISTE_POSICION)
 				printf("Error, no existe la posicion.\n");
 		}
+		else if(resultado==GUARDA_PARTIDA){
+			printf("Ingrese el nombre de la partida: ");
+			leeNombre(partida);
+			if(guardarPartida(partida)==1)
+				printf("Partida guardada.\n");
+			else
+				printf("Error al guardar la partida.\n");
+		}
 		else if(resultado==SALE_SIN_GUARDAR)
 				flagMovimiento=EXITO;
 	}while(flagMovimiento!=EXITO);
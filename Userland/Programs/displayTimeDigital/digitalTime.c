@@ -13,6 +13,12 @@ static unsigned char R = 255;
 static unsigned char G = 255;
 static unsigned char B = 255;
 
+int main(int argc, char **argv)
+{
+    startDigitalTime();
+    return 0;
+}
+
 void startDigitalTime()
 {
     int lastTime[7];
@@ -31,7 +37,7 @@ void startDigitalTime()
     printMinute(actualTime);
     printSecond(actualTime);
 
-    while ((c = getchar()) != 'b' && c != 27)
+    while ((c = tryGetchar()) != 'b' && c != 27)
     {
         getAllTimes(actualTime);
         if (actualTime[0] > lastTime[0])
@@ -3,9 +3,15 @@
 #include <messages.h>
 #include <processExec.h>
 #include <shell.h>
+#include <messageTest.h>
 
 void newProcess(int argc, char**argv);
 
+int main(int argc, char**argv){
+  messageTest(argc, argv);
+  return 0;
+}
+
 void messageTest(int argc, char**argv){
   int processes = 4;
 
@@ -22,10 +28,7 @@ void messageTest(int argc, char**argv){
   char *msg = "holaaa\n";
 
   printf("Sending: %s\n", msg);
-  for(int i=0; i< processes; i++){
-
-    send(processesPids[i], msg, strlenUserland(msg));
-  }
+  multicast(processesPids, processes, msg, strlenUserland(msg));
 
   exitProcess();
 }
@@ -1,5 +1,7 @@
+#include <prodcons.h>
 #include <stdio.h>
 #include <mutex.h>
+#include <condition.h>
 #include <stdio.h>
 #include <exitProcess.h>
 #include <processExec.h>
@@ -9,11 +11,14 @@
 #define MAX_ITEMS 10
 
 static void*mutex;
+static void*notFull, *notEmpty;
 static int items=0;
 static int prod=0, cons=0;
 
 void killProducer(){
   if(cons == 0 && prod==0){
+    conditionClose(notFull);
+    conditionClose(notEmpty);
     mutexClose(mutex);
     printf("Killing last child.\n");
     exitProcess();
@@ -26,6 +31,8 @@ void killProducer(){
 
 void killConsumer(){
   if(cons == 0 && prod==0){
+    conditionClose(notFull);
+    conditionClose(notEmpty);
     mutexClose(mutex);
     printf("Killing last child.\n");
     exitProcess();
@@ -40,13 +47,15 @@ void producer(int argc, char ** argv){
   int num = argc;
   while(1){
     mutexLock(mutex);
+    while(items == MAX_ITEMS && num <= prod){
+      conditionWait(notFull, mutex);
+    }
     if(num > prod){
       killProducer();
     }
-    if(items < MAX_ITEMS){
-      items++;
-      printf("Producer (%d): item %d added.\n", num, items);
-    }
+    items++;
+    printf("Producer (%d): item %d added.\n", num, items);
+    conditionSignal(notEmpty);
     mutexUnlock(mutex);
   }
 }
@@ -55,13 +64,15 @@ void consumer(int argc, char ** argv){
   int num = argc;
   while(1){
     mutexLock(mutex);
+    while(items == 0 && num <= cons){
+      conditionWait(notEmpty, mutex);
+    }
     if(num > cons){
       killConsumer();
     }
-    if(items > 0){
-      printf("Consumer (%d): item %d removed.\n",num, items);
-      items--;
-    }
+    printf("Consumer (%d): item %d removed.\n",num, items);
+    items--;
+    conditionSignal(notFull);
     mutexUnlock(mutex);
   }
 }
@@ -70,6 +81,8 @@ void killLastConsumer(){
   int flag =0;
   mutexLock(mutex);
   cons = cons>0?cons-1:0;
+  //el que se saca puede estar esperando
+  conditionBroadcast(notEmpty);
   if(prod == 0 && cons == 0)
     flag=1;
   mutexUnlock(mutex);
@@ -83,6 +96,7 @@ void killLastProducer(){
   int flag =0;
   mutexLock(mutex);
   prod = prod>0?prod-1:0;
+  conditionBroadcast(notFull);
   if(prod == 0 && cons == 0)
     flag=1;
   mutexUnlock(mutex);
@@ -92,8 +106,15 @@ void killLastProducer(){
   }
 }
 
+int main(int argc, char ** argv){
+  prodcons();
+  return 0;
+}
+
 void prodcons(){
   mutex = mutexInit("prodcons");
+  notFull = conditionInit("prodconsNotFull");
+  notEmpty = conditionInit("prodconsNotEmpty");
   printf("::: Prodcons :::\n");
   printf("'c'/'x' to add/remove consumer, 'p'/'o' to add/remove producer and 'q' to quit.\n\n");
   char c;
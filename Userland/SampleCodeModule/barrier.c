@@ -0,0 +1,14 @@
+#include <systemCall.h>
+#include <barrier.h>
+
+void * barrierInit(char *name, int count){
+  return (void *)systemCall(60, (uint64_t)name, count, 0,0,0);
+}
+
+int barrierWait(void * barrier){
+  return (int)systemCall(61, (uint64_t)barrier, 0,0,0,0);
+}
+
+int barrierClose(void * barrier){
+  return (int)systemCall(62, (uint64_t)barrier, 0,0,0,0);
+}
@@ -0,0 +1,22 @@
+#include <systemCall.h>
+#include <condition.h>
+
+void * conditionInit(char *name){
+  return (void *)systemCall(37, (uint64_t)name, 0,0,0,0);
+}
+
+int conditionWait(void * condition, void * mutex){
+  return (int)systemCall(38, (uint64_t)condition, (uint64_t)mutex, 0,0,0);
+}
+
+int conditionSignal(void * condition){
+  return (int)systemCall(39, (uint64_t)condition, 0,0,0,0);
+}
+
+int conditionBroadcast(void * condition){
+  return (int)systemCall(40, (uint64_t)condition, 0,0,0,0);
+}
+
+int conditionClose(void * condition){
+  return (int)systemCall(41, (uint64_t)condition, 0,0,0,0);
+}
@@ -32,6 +32,8 @@ void help()
     printf("             messageTest :: sends a message to multiple processes\n");
     printf("             prodcons if you like to see our resolution to prodcons problem\n");
     printf("             printPids (with cammelCase) if you like to print pids of processes\n");
+    printf("             bootTimes shows how long each phase of the boot took\n");
+    printf("          Start a command with & to run it in background, &%30 to also cap it at 30% CPU\n");
     printf("              Write exceptionZero for trying our divZero exception catch\n");
     printf("              Write exceptionOpCode for trying our opCode exception catch\n");
     printf("                           If you want to exit, write exit\n");
@@ -65,3 +67,17 @@ void displayTime()
    printTimeUTC();
     exitProcess();
 }
+
+void printBootTimes()
+{
+    bootTime times[BOOT_PHASES];
+    int count = getBootTimes(times, BOOT_PHASES), total = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        printf("%s: %d us\n", times[i].name, (int)times[i].micros);
+        total += (int)times[i].micros;
+    }
+    printf("Total: %d us\n", total);
+    exitProcess();
+}
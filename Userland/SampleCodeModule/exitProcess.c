@@ -1,8 +1,15 @@
 #include <stdio.h>
 #include <processExec.h>
+#include <systemCall.h>
+#include <exitProcess.h>
 
 void exitProcess(){
     printf("\n$>");
   sysKillProcess();
 
 }
+
+/* Termina el proceso entero, el padre lee status con waitpid */
+void exit(int status){
+  systemCall(67, (uint64_t)status, 0, 0, 0, 0);
+}
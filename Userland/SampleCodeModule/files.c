@@ -0,0 +1,30 @@
+#include <systemCall.h>
+#include <files.h>
+
+int open(char *name, int flags){
+  return (int)systemCall(23, (uint64_t)name, flags, 0, 0, 0);
+}
+
+int read(int fd, void *buffer, int length){
+  return (int)systemCall(24, fd, (uint64_t)buffer, length, 0, 0);
+}
+
+int write(int fd, void *buffer, int length){
+  return (int)systemCall(25, fd, (uint64_t)buffer, length, 0, 0);
+}
+
+int close(int fd){
+  return (int)systemCall(26, fd, 0, 0, 0, 0);
+}
+
+void *mmap(int fd, uint64_t offset, uint64_t length){
+  return (void *)systemCall(27, fd, offset, length, 0, 0);
+}
+
+int msync(void *address, uint64_t length){
+  return (int)systemCall(28, (uint64_t)address, length, 0, 0, 0);
+}
+
+int munmap(void *address){
+  return (int)systemCall(29, (uint64_t)address, 0, 0, 0, 0);
+}
@@ -0,0 +1,10 @@
+#include <systemCall.h>
+#include <futex.h>
+
+int futexWait(int *address, int expected){
+  return (int)systemCall(35, (uint64_t)address, (uint64_t)expected, 0, 0, 0);
+}
+
+int futexWake(int *address, int count){
+  return (int)systemCall(36, (uint64_t)address, (uint64_t)count, 0, 0, 0);
+}
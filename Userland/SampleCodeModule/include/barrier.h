@@ -0,0 +1,13 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+/* Opens the barrier name for count processes or threads. If it already
+** exists count is ignored. */
+void * barrierInit(char *name, int count);
+
+/* Returns 1 to the last one to arrive and 0 to the rest */
+int barrierWait(void * barrier);
+
+int barrierClose(void * barrier);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef CONDITION_H
+#define CONDITION_H
+
+void * conditionInit(char *name);
+
+/* Releases the mutex while sleeping and takes it again before returning.
+** Wakeups may be spurious, check the condition in a loop. */
+int conditionWait(void * condition, void * mutex);
+
+int conditionSignal(void * condition);
+
+int conditionBroadcast(void * condition);
+
+int conditionClose(void * condition);
+
+#endif
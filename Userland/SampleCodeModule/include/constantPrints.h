@@ -10,5 +10,6 @@ void printTimeUTC();
 void help();
 void info();
 void displayTime();
+void printBootTimes();
 
 #endif
\ No newline at end of file
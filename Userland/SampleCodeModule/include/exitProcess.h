@@ -2,6 +2,7 @@
 #define EXIT_H
 
 void exitProcess();
+void exit(int status);
 
 
 #endif
@@ -0,0 +1,21 @@
+#ifndef FILES_H
+#define FILES_H
+
+#include <stdint.h>
+
+/* open flags */
+#define O_CREATE 0x1
+#define O_TRUNCATE 0x2
+
+int open(char *name, int flags);
+int read(int fd, void *buffer, int length);
+int write(int fd, void *buffer, int length);
+int close(int fd);
+
+/* Maps a file from a page aligned offset, NULL on error. The size of the
+** file doesn't change, what is written past its end is not kept. */
+void *mmap(int fd, uint64_t offset, uint64_t length);
+int msync(void *address, uint64_t length);
+int munmap(void *address);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+/* Sleeps while *address == expected, returns 0 if it had already changed */
+int futexWait(int *address, int expected);
+
+/* Wakes up to count processes waiting on address, returns how many */
+int futexWake(int *address, int count);
+
+#endif
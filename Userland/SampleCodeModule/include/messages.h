@@ -1,7 +1,71 @@
 #ifndef MESSAGES_H
 #define MESSAGES_H
 
-void send(int pid, char* msg, int length);
-void receive(int pid, char* dest, int length);
+#include <stdint.h>
+
+/* Each process queues at most QUEUE_MAX_BYTES in QUEUE_MAX_MESSAGES.
+** send waits for room and returns length, or -1 if pid is gone. */
+#define QUEUE_MAX_BYTES 16384
+#define QUEUE_MAX_MESSAGES 16
+
+int send(int pid, char* msg, int length);
+
+/* Returns 0 instead of waiting when the queue is full, -1 if it could
+** never fit */
+int trySend(int pid, char* msg, int length);
+
+/* Sends the same message to every pid, copying the text only once.
+** Returns how many of them got all of it. */
+int multicast(int *pids, int count, char* msg, int length);
+
+typedef struct queueStats{
+  int bytes;
+  int messages;
+  int highBytes;
+  int highMessages;
+  int blockedSends;
+  int rejectedSends;
+} queueStats;
+
+int getQueueStats(int pid, queueStats *stats);
+
+/* Any sender for receive, tryReceive and poll. All the bytes come from
+** the same one. */
+#define POLL_ANY -1
+
+/* Returns the sender */
+int receive(int pid, char* dest, int length);
+
+/* Like receive but never blocks: returns the sender if the bytes were
+** there and -1 otherwise */
+int tryReceive(int pid, char* dest, int length);
+
+typedef struct pollEntry{
+  int pid;     /* Sender, or POLL_ANY */
+  int length;  /* Bytes needed to be ready */
+  int ready;   /* Set by poll */
+  int sender;  /* Set by poll, who to receive from */
+} pollEntry;
+
+/* Waits until at least one entry can be received without blocking or
+** millis go by. 0 returns at once and a negative timeout waits forever.
+** Returns how many entries are ready. */
+int poll(pollEntry *entries, int count, int millis);
+
+/* Small fixed size message for call/replyAndWait */
+#define IPC_WORDS 4
+
+typedef struct ipcMessage{
+  uint64_t word[IPC_WORDS];
+} ipcMessage;
+
+/* Sends request and blocks until the server replies. If the server is
+** already waiting it runs right away on the rest of our quantum.
+** Returns -1 if the server doesn't exist or exits before replying. */
+int call(int pid, const ipcMessage *request, ipcMessage *reply);
+
+/* Replies to client (pass -1 the first time) and waits for the next
+** request. Returns who sent it, the client of the next reply. */
+int replyAndWait(int client, const ipcMessage *reply, ipcMessage *request);
 
 #endif
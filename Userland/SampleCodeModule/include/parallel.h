@@ -0,0 +1,14 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/* Threads started by each parallelFor, the caller also works */
+#define PARALLEL_WORKERS 3
+
+typedef void (*parallelFunction)(int index, void *argument);
+
+/* Calls function(i, argument) for every i in [0, n), splitting the range
+** between the caller and worker threads, and returns once they are all
+** joined. Parts whose thread can't be created run on the caller. */
+void parallelFor(int n, parallelFunction function, void *argument);
+
+#endif
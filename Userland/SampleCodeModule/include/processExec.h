@@ -1,8 +1,22 @@
 
 #ifndef EXECPROCESS_H_
 #define EXECPROCESS_H_
+
+/* waitpid */
+#define WAIT_ANY -1
+#define WNOHANG 1
+#define KILLED_STATUS -1
+
 int execProcess(void* function,int argc, char** argv, char* name, int foreground);
+int spawnProcess(char* name, int argc, char** argv, int foreground);
+int execProcessWithQuota(void* function,int argc, char** argv, char* name, int foreground, int quota);
+int spawnProcessWithQuota(char* name, int argc, char** argv, int foreground, int quota);
 void sysSetForeground(int pid);
 void sysKillProcess();
 void printPids();
+int getPid();
+int yieldTo(int pid);
+int setCpuQuota(int pid, int percent);
+int getCpuQuota(int pid);
+int waitpid(int pid, int *status, int flags);
 #endif
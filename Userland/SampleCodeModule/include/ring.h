@@ -0,0 +1,45 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+
+/* Batches of system calls run by kernel workers of the process.
+** Submissions are plain system call numbers and arguments; each one
+** completes with its return value and the userData it was sent with.
+** Up to RING_WORKERS blocking calls can be waiting at once.
+** A sleep is a poll (51) with no entries and a timeout. */
+#define RING_ENTRIES 32
+#define RING_WORKERS 4
+
+typedef struct ringSubmission{
+  uint64_t operation;
+  uint64_t argument[5];
+  uint64_t userData;
+} ringSubmission;
+
+typedef struct ringCompletion{
+  uint64_t userData;
+  uint64_t result;
+} ringCompletion;
+
+typedef struct ioRing{
+  volatile uint32_t sqHead;
+  volatile uint32_t sqTail;
+  volatile uint32_t cqHead;
+  volatile uint32_t cqTail;
+  ringSubmission sq[RING_ENTRIES];
+  ringCompletion cq[RING_ENTRIES];
+} ioRing;
+
+ioRing *ringSetup();
+
+/* Queues a call without entering the kernel, returns 0 if sq is full */
+int ringSubmit(ioRing *ring, uint64_t operation, uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t userData);
+
+/* Starts what was submitted and waits for minComplete completions */
+int ringEnter(int minComplete);
+
+/* Takes the oldest completion, returns 0 if there is none */
+int ringComplete(ioRing *ring, ringCompletion *completion);
+
+#endif
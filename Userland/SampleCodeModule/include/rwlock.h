@@ -0,0 +1,17 @@
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+/* Many readers or a single writer. Waiting writers go before new readers. */
+void * rwlockInit(char *name);
+
+int readLock(void * lock);
+
+int readUnlock(void * lock);
+
+int writeLock(void * lock);
+
+int writeUnlock(void * lock);
+
+int rwlockClose(void * lock);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+
+#define SCHED_FAIR 0     /* Round robin, the default */
+#define SCHED_FIFO 1     /* Runs until it blocks or yields, priority 1 to 99 */
+#define SCHED_DEADLINE 2 /* Gets runtime milliseconds every period */
+
+typedef struct schedAttr{
+  int policy;
+  int priority;
+  uint64_t runtime;
+  uint64_t period;
+} schedAttr;
+
+/* pid is a process or thread id, returns 0 if the attributes are
+** invalid or the deadline tasks wouldn't fit */
+int schedSetAttr(int pid, schedAttr *attr);
+
+int schedGetAttr(int pid, schedAttr *attr);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <stdint.h>
+
+/* Opens the region name, creating it filled with zeros if nobody has it
+** open. Every process that opens it gets the same memory, until the
+** last one closes it or exits. Up to 1MB; returns NULL on error. */
+void *shmOpen(char *name, uint64_t size);
+
+int shmClose(void *address);
+
+#endif
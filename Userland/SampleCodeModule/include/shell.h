@@ -4,11 +4,9 @@
 #include <stdio.h>
 #include <constantPrints.h>
 #include <stdlib.h>
-#include <blobsFront.h>
-#include <digitalTime.h>
+#include <time.h>
 #include <processExec.h>
 #include <instructions.h>
-#include <messageTest.h>
 
 #define MAX_WORD_LENGTH 124
 #define MAX_WORDS 32
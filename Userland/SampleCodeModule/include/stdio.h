@@ -14,8 +14,10 @@
 
 int strlenUserland(const char *s);
 void beepSound();
+int playTone(unsigned int frequency, unsigned int millis);
 int abs(int a);
 int getchar();
+int tryGetchar();
 void setPixel(unsigned int x, unsigned int y);
 void printPixelBackGroundColor(unsigned int x, unsigned int y);
 void setBackGroundColor(unsigned int red, unsigned int blue, unsigned int green);
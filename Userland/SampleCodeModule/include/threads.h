@@ -0,0 +1,15 @@
+#ifndef THREADS_H
+#define THREADS_H
+
+typedef void *(*threadFunction)(void *argument);
+
+/* Threads share memory, files, messages and pid with their process.
+** Returns the thread id, or -1 if there are too many. */
+int threadCreate(threadFunction function, void *argument);
+
+/* Waits for a thread of the same process, result may be NULL */
+int threadJoin(int tid, void **result);
+
+void threadExit(void *result);
+
+#endif
@@ -5,10 +5,22 @@
 
 #define NULL 0
 
+/* Same layout as the kernel's boot report */
+#define BOOT_NAME_LENGTH 16
+#define BOOT_PHASES 9
+
+typedef struct
+{
+    char name[BOOT_NAME_LENGTH];
+    uint64_t cycles;
+    uint64_t micros;
+} bootTime;
+
 long int time();
 void getAllTimes(int times[7]);
 int getTimeUTC();
 void setTimeUTC(int newUTC);
 void printTime();
+int getBootTimes(bootTime *times, int count);
 
 #endif
\ No newline at end of file
@@ -1,9 +1,38 @@
 #include <systemCall.h>
+#include <messages.h>
 
-void send(int pid, char* msg, int length){
-  systemCall(11, pid, msg, length,0,0);
+int send(int pid, char* msg, int length){
+  return (int)systemCall(11, pid, msg, length,0,0);
 }
 
-void receive(int pid, char* msg, int length){
-  systemCall(12, pid, msg, length,0,0);
+int multicast(int *pids, int count, char* msg, int length){
+  return (int)systemCall(55, (uint64_t)pids, count, (uint64_t)msg, length,0);
+}
+
+int trySend(int pid, char* msg, int length){
+  return (int)systemCall(53, pid, (uint64_t)msg, length,0,0);
+}
+
+int getQueueStats(int pid, queueStats *stats){
+  return (int)systemCall(54, pid, (uint64_t)stats, 0,0,0);
+}
+
+int receive(int pid, char* msg, int length){
+  return (int)systemCall(12, pid, msg, length,0,0);
+}
+
+int call(int pid, const ipcMessage *request, ipcMessage *reply){
+  return (int)systemCall(48, pid, (uint64_t)request, (uint64_t)reply,0,0);
+}
+
+int replyAndWait(int client, const ipcMessage *reply, ipcMessage *request){
+  return (int)systemCall(49, client, (uint64_t)reply, (uint64_t)request,0,0);
+}
+
+int tryReceive(int pid, char* dest, int length){
+  return (int)systemCall(52, pid, (uint64_t)dest, length,0,0);
+}
+
+int poll(pollEntry *entries, int count, int millis){
+  return (int)systemCall(51, (uint64_t)entries, count, millis,0,0);
 }
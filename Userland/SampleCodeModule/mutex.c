@@ -1,15 +1,32 @@
 #include <systemCall.h>
+#include <futex.h>
+
+/* El kernel deja el valor al principio del mutex:
+** 1 libre, 0 tomado, -1 tomado con procesos esperando.
+** Solo se entra al kernel si hay contencion. */
 
 void * mutexInit(char *name){
   return systemCall(16, name, 0,0,0,0);
 }
 
 int mutexLock(void * mutex){
-  return systemCall(18, mutex, 0,0,0,0);
+  int *value = (int *)mutex;
+
+  if (__sync_bool_compare_and_swap(value, 1, 0))
+    return 0;
+
+  /* Marcarlo como contendido antes de dormir, asi el que lo suelte nos despierta */
+  while (__sync_lock_test_and_set(value, -1) != 1)
+    futexWait(value, -1);
+  return 0;
 }
 
 int mutexUnlock(void * mutex){
-  return systemCall(17, mutex, 0,0,0,0);
+  int *value = (int *)mutex;
+
+  if (__sync_lock_test_and_set(value, 1) == -1)
+    futexWake(value, 1);
+  return 1;
 }
 
 int mutexClose(void * mutex){
@@ -0,0 +1,59 @@
+#include <stdint.h>
+#include <parallel.h>
+#include <threads.h>
+
+#define PARTS (PARALLEL_WORKERS + 1)
+
+//las partes van en el stack del que llama: procesos del mismo programa
+//comparten las variables globales de la imagen, asi no se pisan
+typedef struct part{
+  parallelFunction function;
+  void *argument;
+  int from;
+  int to;
+} part;
+
+static void *worker(void *p);
+static void runPart(part *p);
+
+void parallelFor(int n, parallelFunction function, void *argument){
+  part parts[PARTS];
+  int tids[PARTS];
+  int size = (n + PARTS - 1) / PARTS, i;
+
+  if (n <= 0)
+    return;
+
+  for (i = 0; i < PARTS; i++){
+    parts[i].function = function;
+    parts[i].argument = argument;
+    parts[i].from = i * size < n ? i * size : n;
+    parts[i].to = (i + 1) * size < n ? (i + 1) * size : n;
+  }
+
+  //la primera parte es del que llama, que tambien hace las que no
+  //consiguieron thread
+  for (i = 1; i < PARTS; i++)
+    tids[i] = parts[i].from < parts[i].to ? threadCreate(worker, &parts[i]) : -1;
+
+  runPart(&parts[0]);
+
+  for (i = 1; i < PARTS; i++){
+    if (tids[i] >= 0)
+      threadJoin(tids[i], 0);
+    else
+      runPart(&parts[i]);
+  }
+}
+
+static void *worker(void *p){
+  runPart((part *)p);
+  return 0;
+}
+
+static void runPart(part *p){
+  int i;
+
+  for (i = p->from; i < p->to; i++)
+    p->function(i, p->argument);
+}
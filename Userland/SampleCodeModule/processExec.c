@@ -4,12 +4,19 @@
 #include <exitProcess.h>
 
 typedef void (*entry_point)(int, char **);
-int sysExec(void *function, int argc, char **argv, char *name);
+int sysExec(void *function, int argc, char **argv, char *name, int quota);
+int sysSpawn(char *name, int argc, char **argv, int quota);
 void sysSetForeground(int pid);
 
 int execProcess(void *function, int argc, char **argv, char *name, int foreground)
 {
-	int pid = sysExec(function, argc, argv, name);
+	return execProcessWithQuota(function, argc, argv, name, foreground, 0);
+}
+
+/* quota es el porcentaje de cpu del proceso y sus hijos, 0 sin limite */
+int execProcessWithQuota(void *function, int argc, char **argv, char *name, int foreground, int quota)
+{
+	int pid = sysExec(function, argc, argv, name, quota);
 	if (foreground == 1)
 	{
 		sysSetForeground(pid);
@@ -17,9 +24,37 @@ int execProcess(void *function, int argc, char **argv, char *name, int foregroun
 	return pid;
 }
 
-int sysExec(void *function, int argc, char **argv, char *name)
+/* Carga y ejecuta el programa name, empaquetado en la imagen por separado */
+int spawnProcess(char *name, int argc, char **argv, int foreground)
+{
+	return spawnProcessWithQuota(name, argc, argv, foreground, 0);
+}
+
+int spawnProcessWithQuota(char *name, int argc, char **argv, int foreground, int quota)
+{
+	char program[MAX_WORD_LENGTH];
+	int i;
+
+	for (i = 0; i < MAX_WORD_LENGTH - 1 && name[i] != 0 && name[i] != '\n'; i++)
+		program[i] = name[i];
+	program[i] = 0;
+
+	int pid = sysSpawn(program, argc, argv, quota);
+	if (pid >= 0 && foreground == 1)
+	{
+		sysSetForeground(pid);
+	}
+	return pid;
+}
+
+int sysExec(void *function, int argc, char **argv, char *name, int quota)
 {
-  return (uint64_t)systemCall(13, (uint64_t)function, argc, (uint64_t)argv, (uint64_t)name, 0);
+  return (uint64_t)systemCall(13, (uint64_t)function, argc, (uint64_t)argv, (uint64_t)name, quota);
+}
+
+int sysSpawn(char *name, int argc, char **argv, int quota)
+{
+  return (int)systemCall(22, (uint64_t)name, argc, (uint64_t)argv, quota, 0);
 }
 
 void sysSetForeground(int pid)
@@ -35,6 +70,26 @@ int getPid(){
 	return systemCall(20,0,0,0,0,0);
 }
 
+/* Le cede el resto del turno a pid, -1 si no esta listo para correr */
+int yieldTo(int pid){
+	return (int)systemCall(50, (uint64_t)pid, 0, 0, 0, 0);
+}
+
+/* Limita a pid y a los hijos que cree a percent de la cpu, 100 lo libera */
+int setCpuQuota(int pid, int percent){
+	return (int)systemCall(65, (uint64_t)pid, (uint64_t)percent, 0, 0, 0);
+}
+
+int getCpuQuota(int pid){
+	return (int)systemCall(66, (uint64_t)pid, 0, 0, 0, 0);
+}
+
+/* Espera a que termine el hijo pid, o cualquiera con WAIT_ANY. Devuelve
+** su pid, 0 con WNOHANG si sigue corriendo y -1 si no hay hijos */
+int waitpid(int pid, int *status, int flags){
+	return (int)systemCall(68, (uint64_t)pid, (uint64_t)status, (uint64_t)flags, 0, 0);
+}
+
 void printPids() {
 	systemCall(15,0,0,0,0,0);
 	exitProcess();
@@ -0,0 +1,39 @@
+#include <systemCall.h>
+#include <ring.h>
+
+ioRing *ringSetup(){
+  return (ioRing *)systemCall(58, 0, 0, 0, 0, 0);
+}
+
+int ringSubmit(ioRing *ring, uint64_t operation, uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t userData){
+  ringSubmission *entry;
+
+  if (ring->sqTail - ring->sqHead == RING_ENTRIES)
+    return 0;
+
+  entry = &ring->sq[ring->sqTail % RING_ENTRIES];
+  entry->operation = operation;
+  entry->argument[0] = a;
+  entry->argument[1] = b;
+  entry->argument[2] = c;
+  entry->argument[3] = d;
+  entry->argument[4] = 0;
+  entry->userData = userData;
+  //el kernel no tiene que ver el tail antes que la entrada
+  __sync_synchronize();
+  ring->sqTail++;
+  return 1;
+}
+
+int ringEnter(int minComplete){
+  return (int)systemCall(59, minComplete, 0, 0, 0, 0);
+}
+
+int ringComplete(ioRing *ring, ringCompletion *completion){
+  if (ring->cqHead == ring->cqTail)
+    return 0;
+
+  *completion = ring->cq[ring->cqHead % RING_ENTRIES];
+  ring->cqHead++;
+  return 1;
+}
@@ -0,0 +1,26 @@
+#include <systemCall.h>
+#include <rwlock.h>
+
+void * rwlockInit(char *name){
+  return (void *)systemCall(42, (uint64_t)name, 0,0,0,0);
+}
+
+int readLock(void * lock){
+  return (int)systemCall(43, (uint64_t)lock, 0,0,0,0);
+}
+
+int readUnlock(void * lock){
+  return (int)systemCall(44, (uint64_t)lock, 0,0,0,0);
+}
+
+int writeLock(void * lock){
+  return (int)systemCall(45, (uint64_t)lock, 0,0,0,0);
+}
+
+int writeUnlock(void * lock){
+  return (int)systemCall(46, (uint64_t)lock, 0,0,0,0);
+}
+
+int rwlockClose(void * lock){
+  return (int)systemCall(47, (uint64_t)lock, 0,0,0,0);
+}
@@ -0,0 +1,10 @@
+#include <systemCall.h>
+#include <sched.h>
+
+int schedSetAttr(int pid, schedAttr *attr){
+  return (int)systemCall(63, pid, (uint64_t)attr, 0,0,0);
+}
+
+int schedGetAttr(int pid, schedAttr *attr){
+  return (int)systemCall(64, pid, (uint64_t)attr, 0,0,0);
+}
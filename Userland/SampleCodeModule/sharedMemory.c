@@ -0,0 +1,10 @@
+#include <systemCall.h>
+#include <sharedMemory.h>
+
+void *shmOpen(char *name, uint64_t size){
+  return (void *)systemCall(56, (uint64_t)name, size, 0, 0, 0);
+}
+
+int shmClose(void *address){
+  return (int)systemCall(57, (uint64_t)address, 0, 0, 0, 0);
+}
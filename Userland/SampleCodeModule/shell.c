@@ -2,13 +2,12 @@
 #include <processExec.h>
 #include <stdio.h>
 #include <exitProcess.h>
-#include <prodcons.h>
 
 static char choice[BUFFER_SIZE];
 
 #define STEP 10
 
-#define CMD_SIZE 14
+#define CMD_SIZE 11
 
 static int isRunning = 1;
 static instruction commands[] = {
@@ -17,15 +16,12 @@ static instruction commands[] = {
 		{"changeBackGroundColor\n", changeBackGroundColor},
 		{"info\n", info},
 		{"clear\n", clearWorkSpace},
-		{"displayTimeDigital\n", startDigitalTime},
 		{"displayTimeConsole\n", displayTime},
-		{"blobWars\n", iniciarBlobWars},
 		{"exceptionZero\n", zeroDiv},
 		{"exit\n", exitProcess},
 		{"exceptionOpCode\n", opCode},
-		{"messageTest\n", messageTest},
 		{"printPids\n", printPids},
-		{"prodcons\n", prodcons}
+		{"bootTimes\n", printBootTimes}
 	};
 
 #define DEFAULT 0
@@ -94,29 +90,50 @@ int callFunction(char *buffer)
 	int words;
 	char **argv;
 
-	int foreground = 1;
+	/* Reapea a los trabajos en background que ya terminaron */
+	while (waitpid(WAIT_ANY, NULL, WNOHANG) > 0)
+		;
+
+	int foreground = 1, quota = 0, pid = -1;
 	if (*buffer == '&')
 	{
 		buffer++;
 		foreground = 0;
 	}
 
+	/* %30 prog corre prog y sus hijos con a lo sumo 30% de la cpu */
+	if (*buffer == '%')
+	{
+		buffer++;
+		buffer += stringToInt(buffer, &quota);
+		if (quota <= 0 || quota > 100)
+		{
+			printf("Wrong quota\n$>");
+			return 0;
+		}
+	}
+
 	parseParams(buffer, &words, &argv);
 	int i, valid = 0;
 	for (i = 0; i < CMD_SIZE && valid == 0; i++)
 	{
 		if (strcmp(argv[0], commands[i].name) == 0)
 		{
-			execProcess(commands[i].function, words, argv, commands[i].name, foreground);
+			pid = execProcessWithQuota(commands[i].function, words, argv, commands[i].name, foreground, quota);
 			valid = 1;
 		}
 	}
 
-	if (valid == 0){
+	/* Si no es un comando del shell, se busca un programa con ese nombre */
+	if (valid == 0 && (pid = spawnProcessWithQuota(argv[0], words, argv, foreground, quota)) < 0){
 		printf("Wrong input\n$>");
 		return 0;
 	}
 
+	/* Mientras corre en foreground el shell duerme en vez de leer el teclado */
+	if (foreground && pid >= 0)
+		waitpid(pid, NULL, 0);
+
 	return 1;
 }
 
@@ -28,6 +28,12 @@ void beepSound()
     systemCall(3, 0, 0, 0, 0, 0);
 }
 
+/* Returns right away, the tone plays in the background. 0 if too many are queued */
+int playTone(unsigned int frequency, unsigned int millis)
+{
+    return (int)systemCall(31, frequency, millis, 0, 0, 0);
+}
+
 void putPixel(unsigned int x, unsigned int y, unsigned char red, unsigned char green, unsigned char blue)
 {
     systemCall(7, (uint64_t)x, (uint64_t)y, (uint64_t)red, (uint64_t)green, (uint64_t)blue);
@@ -61,7 +67,14 @@ void setCharColor(unsigned int red, unsigned int green, unsigned int blue)
     charB = blue;
 }
 
+/* Waits for a key while the process is in the foreground */
 int getchar()
+{
+    return systemCall(1, 1, 0, 0, 0, 0);
+}
+
+/* EOF right away if no key was pressed */
+int tryGetchar()
 {
     return systemCall(1, 0, 0, 0, 0, 0);
 }
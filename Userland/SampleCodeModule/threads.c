@@ -0,0 +1,19 @@
+#include <systemCall.h>
+#include <threads.h>
+
+/* Lo que devuelve la funcion del thread es su resultado */
+static void threadStart(threadFunction function, void *argument){
+  threadExit(function(argument));
+}
+
+int threadCreate(threadFunction function, void *argument){
+  return (int)systemCall(32, (uint64_t)threadStart, (uint64_t)function, (uint64_t)argument, 0, 0);
+}
+
+int threadJoin(int tid, void **result){
+  return (int)systemCall(33, tid, (uint64_t)result, 0, 0, 0);
+}
+
+void threadExit(void *result){
+  systemCall(34, (uint64_t)result, 0, 0, 0, 0);
+}
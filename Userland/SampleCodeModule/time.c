@@ -176,4 +176,9 @@ void setTimeUTC(int newUTC)
 {
     if(newUTC>=-12 || newUTC<=12)
         UTC = newUTC;
-}
\ No newline at end of file
+}
+
+int getBootTimes(bootTime *times, int count)
+{
+    return (int)systemCall(30, (uint64_t)times, count, 0, 0, 0);
+}